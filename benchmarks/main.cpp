@@ -0,0 +1,113 @@
+#include "../src/nes/core.hpp"
+#include "../src/nes/cartridge.hpp"
+#include "../src/nes/flat_bus.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+namespace
+{
+	// loads, adds, stores and branches out of ram, the same bytes run on both buses
+	constexpr uint16_t CPU_LOOP_ADDRESS = 0x0300;
+	constexpr std::array<uint8_t, 16> cpu_loop{
+		0xA2, 0x00,		  // LDX #0
+		0xBD, 0x00, 0x04, // LDA $0400,X
+		0x69, 0x03,		  // ADC #3
+		0x9D, 0x00, 0x04, // STA $0400,X
+		0xE8,			  // INX
+		0xD0, 0xF5,		  // BNE to the LDA
+		0x4C, 0x00, 0x03, // JMP $0300
+	};
+
+	// millions of instructions per second
+	template <class BusType>
+	double run_cpu_loop(NESterpiece::CPU<BusType> &cpu, BusType &bus, uint32_t instructions)
+	{
+		cpu.reset_to_address(CPU_LOOP_ADDRESS);
+		const auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < instructions; ++i)
+			cpu.step(bus);
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return instructions / elapsed.count() / 1e6;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fmt::print("usage: Benchmarks <rom> [frames]\n");
+		return 1;
+	}
+
+	auto cart = NESterpiece::Cartridge::from_file(argv[1]);
+	if (!cart)
+	{
+		fmt::print("Unable to load rom.\n");
+		return 1;
+	}
+
+	const uint32_t num_frames = argc > 2 ? std::stoul(argv[2]) : 3000;
+	auto core = std::make_unique<NESterpiece::Core>();
+	core->reset(std::move(cart));
+
+	// the cpu alone against the cpu driving the whole machine, on a core of its own so
+	// the frame timing below starts from the same power on state as before
+	{
+		constexpr uint32_t cpu_instructions = 20'000'000;
+		NESterpiece::CPU<NESterpiece::FlatBus> flat_cpu;
+		NESterpiece::FlatBus flat_bus;
+		std::copy(cpu_loop.begin(), cpu_loop.end(), flat_bus.memory.begin() + CPU_LOOP_ADDRESS);
+
+		auto cpu_core = std::make_unique<NESterpiece::Core>();
+		cpu_core->reset(NESterpiece::Cartridge::from_image(core->bus.cart->rom));
+		std::copy(cpu_loop.begin(), cpu_loop.end(), cpu_core->bus.internal_ram.begin() + CPU_LOOP_ADDRESS);
+
+		fmt::print("cpu on flat bus: {:.1f}M instructions/s\n", run_cpu_loop(flat_cpu, flat_bus, cpu_instructions));
+		fmt::print("cpu on core bus: {:.1f}M instructions/s\n", run_cpu_loop(cpu_core->cpu, cpu_core->bus, cpu_instructions));
+	}
+
+	// let the game get past its boot sequence before timing
+	for (uint32_t i = 0; i < 60; ++i)
+		core->tick_until_vblank();
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < num_frames; ++i)
+		core->tick_until_vblank();
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	fmt::print("frames: {}\n", num_frames);
+	fmt::print("time: {:.3f}s\n", elapsed.count());
+	fmt::print("fps: {:.1f}\n", num_frames / elapsed.count());
+
+	constexpr uint32_t state_iterations = 10000;
+	std::vector<uint8_t> state;
+	core->save_state(state);
+
+	const auto save_start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < state_iterations; ++i)
+		core->save_state(state);
+	const std::chrono::duration<double, std::micro> save_elapsed = std::chrono::steady_clock::now() - save_start;
+
+	const auto load_start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < state_iterations; ++i)
+		core->load_state(state.data(), state.size());
+	const std::chrono::duration<double, std::micro> load_elapsed = std::chrono::steady_clock::now() - load_start;
+
+	fmt::print("state size: {} bytes\n", state.size());
+	fmt::print("state save: {:.2f}us\n", save_elapsed.count() / state_iterations);
+	fmt::print("state load: {:.2f}us\n", load_elapsed.count() / state_iterations);
+
+	auto branch = std::make_unique<NESterpiece::Core>();
+	core->copy_into(*branch);
+	const auto clone_start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < state_iterations; ++i)
+		core->copy_into(*branch);
+	const std::chrono::duration<double, std::micro> clone_elapsed = std::chrono::steady_clock::now() - clone_start;
+	fmt::print("state clone: {:.2f}us\n", clone_elapsed.count() / state_iterations);
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,379 @@
+#include "../src/nes/core.hpp"
+#include "../src/nes/cartridge.hpp"
+#include "../src/nes/movie.hpp"
+#include "../src/nes/rewind.hpp"
+#include "../src/nes/scheduler.hpp"
+#include "../src/nes/state_hash.hpp"
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <fmt/format.h>
+
+namespace
+{
+	using namespace NESterpiece;
+
+	constexpr const char *TEST_ROM = "roms/test.nes";
+
+	// ram the test rom keeps its state in, see roms/make_test_rom.py
+	constexpr uint16_t FRAME_COUNT = 0x13;
+	constexpr uint16_t NMI_COUNT = 0x14;
+
+	bool expect(bool condition, std::string_view what)
+	{
+		if (!condition)
+			fmt::print("failed: {}\n", what);
+		return condition;
+	}
+
+	std::unique_ptr<Core> boot_test_rom()
+	{
+		auto cart = Cartridge::from_file(TEST_ROM);
+		if (!cart)
+		{
+			fmt::print("Unable to load {}.\n", TEST_ROM);
+			return nullptr;
+		}
+
+		auto core = std::make_unique<Core>();
+		core->reset(std::move(cart));
+		return core;
+	}
+
+	// runs count frames from first with input that changes every frame, returns the hash
+	// of the machine afterwards
+	uint64_t run_frames(Core &core, uint32_t first, uint32_t count)
+	{
+		for (uint32_t frame = first; frame < first + count; ++frame)
+		{
+			core.bus.pad.set_buttons(static_cast<uint8_t>(frame * 37));
+			core.tick_until_vblank();
+		}
+		return hash_state(core);
+	}
+
+	bool scheduler()
+	{
+		bool ok = true;
+
+		Scheduler events;
+		events.schedule(EventType::OAMDMA, 300);
+		events.schedule(EventType::VBlank, 100);
+		events.schedule(EventType::PreRender, 200);
+		events.schedule(EventType::StopRun, 50);
+
+		// a second event of a pending type only ever moves it earlier
+		events.schedule(EventType::OAMDMA, 500);
+		events.schedule(EventType::VBlank, 75);
+
+		const std::array<ScheduledEvent, 4> expected{{
+			{.timestamp = 50, .type = EventType::StopRun},
+			{.timestamp = 75, .type = EventType::VBlank},
+			{.timestamp = 200, .type = EventType::PreRender},
+			{.timestamp = 300, .type = EventType::OAMDMA},
+		}};
+		for (const auto &event : expected)
+		{
+			const ScheduledEvent popped = events.pop();
+			ok &= expect(popped.timestamp == event.timestamp && popped.type == event.type, "events pop in timestamp order");
+		}
+		ok &= expect(events.next_timestamp() == std::numeric_limits<uint64_t>::max(), "nothing is left pending");
+
+		events.schedule(EventType::VBlank, 100);
+		events.schedule(EventType::StopRun, 150);
+		events.schedule(EventType::PreRender, 200);
+		events.cancel(EventType::StopRun);
+		events.cancel(EventType::OddFrameSkip);
+		ok &= expect(events.pop().type == EventType::VBlank, "cancel keeps earlier events");
+		ok &= expect(events.pop().type == EventType::PreRender, "cancel removes only its type");
+		ok &= expect(events.next_timestamp() == std::numeric_limits<uint64_t>::max(), "the cancelled event never fires");
+
+		// vblank, pre-render and the odd frame skip chain through the scheduler, the rom
+		// counts one nmi and one main loop pass per frame
+		auto core = boot_test_rom();
+		if (!core)
+			return false;
+
+		for (uint32_t i = 0; i < 120; ++i)
+			core->tick_until_vblank();
+		const auto &ram = core->bus.internal_ram;
+		ok &= expect(ram[NMI_COUNT] > 100 && ram[NMI_COUNT] < 120, "an nmi fires every frame");
+		ok &= expect(ram[FRAME_COUNT] == ram[NMI_COUNT], "every nmi is seen by the main loop");
+		return ok;
+	}
+
+	bool sprite_priority()
+	{
+		auto core = boot_test_rom();
+		if (!core)
+			return false;
+
+		for (uint32_t i = 0; i < 3; ++i)
+			core->tick_until_vblank();
+		const auto pixel = [&](uint32_t x, uint32_t y) { return core->ppu.frame.pixels[(y * 256) + x] & 0x3F; };
+
+		// oam 1 is behind the background and oam 2 in front of it at the same spot, the
+		// lower entry owns the pixel so over the opaque top half the background shows
+		bool ok = true;
+		ok &= expect(pixel(103, 64) == 0x16, "a lower sprite behind the background hides a higher one in front");
+		ok &= expect(pixel(103, 184) == 0x31, "the lower sprite wins over a transparent background");
+		ok &= expect(pixel(50, 64) == 0x16 && pixel(50, 184) == 0x0F, "the background shows where no sprite is");
+		ok &= expect(core->ppu.status & PPUStatusFlags::Sprite0Hit, "sprite 0 over the opaque background hits");
+		return ok;
+	}
+
+	bool save_state()
+	{
+		auto core = boot_test_rom();
+		if (!core)
+			return false;
+
+		run_frames(*core, 0, 30);
+		std::vector<uint8_t> state;
+		core->save_state(state);
+		const uint64_t expected = run_frames(*core, 30, 20);
+
+		// frames aren't part of a state, the next frame redraws everything
+		bool ok = true;
+		ok &= expect(core->load_state(state.data(), state.size()), "a state loads into the core it came from");
+		ok &= expect(run_frames(*core, 30, 20) == expected, "the loaded core runs the same frames again");
+
+		auto fresh = boot_test_rom();
+		ok &= expect(fresh->load_state(state.data(), state.size()), "a state loads into a freshly booted core");
+		ok &= expect(run_frames(*fresh, 30, 20) == expected, "the fresh core runs the same frames");
+
+		std::vector<uint8_t> again;
+		fresh->save_state(again);
+		core->save_state(state);
+		ok &= expect(again == state, "both cores save the same state");
+
+		// a broken blob is rejected and leaves the machine alone
+		ok &= expect(!core->load_state(state.data(), state.size() / 2), "a truncated state is rejected");
+		state[0] ^= 0xFF;
+		ok &= expect(!core->load_state(state.data(), state.size()), "a state with a bad header is rejected");
+		ok &= expect(run_frames(*core, 50, 10) == run_frames(*fresh, 50, 10), "a rejected state changes nothing");
+		return ok;
+	}
+
+	bool rewind()
+	{
+		auto core = boot_test_rom();
+		if (!core)
+			return false;
+
+		// a keyframe every fourth state, so stepping back crosses several of them
+		constexpr uint32_t FRAMES = 20;
+		RewindBuffer history(64 << 20, 4);
+		std::vector<std::vector<uint8_t>> states(FRAMES);
+		std::vector<uint64_t> hashes(FRAMES);
+		for (uint32_t frame = 0; frame < FRAMES; ++frame)
+		{
+			// like the frontend, the state from before the frame and the buttons it runs with
+			const auto buttons = static_cast<uint8_t>(frame * 37);
+			core->save_state(states[frame]);
+			history.push(states[frame], buttons);
+			hashes[frame] = run_frames(*core, frame, 1);
+		}
+
+		// stepping back drops the frame on screen and redraws the one before it
+		bool ok = true;
+		std::vector<uint8_t> state;
+		uint8_t buttons = 0;
+		for (uint32_t frame = FRAMES - 1; frame > 0; --frame)
+		{
+			history.pop();
+			if (!expect(history.peek(state, buttons), "there is history left"))
+				return false;
+
+			ok &= expect(state == states[frame - 1] && buttons == static_cast<uint8_t>((frame - 1) * 37), "every state decodes with its buttons");
+			core->load_state(state.data(), state.size());
+			core->bus.pad.set_buttons(buttons);
+			core->tick_until_vblank();
+			ok &= expect(hash_state(*core) == hashes[frame - 1], "the redrawn frame is the one that ran before");
+		}
+
+		ok &= expect(history.size() == 1, "only the first state is left");
+		ok &= expect(history.pop() && !history.pop() && !history.peek(state, buttons), "the history runs out");
+		return ok;
+	}
+
+	bool clone()
+	{
+		auto core = boot_test_rom();
+		if (!core)
+			return false;
+
+		run_frames(*core, 0, 30);
+		auto copy = core->clone();
+		const uint64_t before = hash_state(*copy);
+
+		bool ok = true;
+		const uint64_t expected = run_frames(*core, 30, 40);
+		ok &= expect(hash_state(*copy) == before, "running the original leaves the clone alone");
+		ok &= expect(run_frames(*copy, 30, 40) == expected, "the clone runs the same frames");
+		ok &= expect(copy->bus.cart != core->bus.cart && copy->bus.cart->rom == core->bus.cart->rom, "only the rom image is shared");
+
+		// copying into a running core replaces its cartridge and all of its state
+		auto target = boot_test_rom();
+		run_frames(*target, 0, 5);
+		core->copy_into(*target);
+		ok &= expect(run_frames(*target, 70, 20) == run_frames(*core, 70, 20), "copy_into makes the same machine");
+		return ok;
+	}
+
+	// the input of a movie's frames, the way the frontend and headless feed it
+	uint64_t play_movie(Core &core, const Movie &movie)
+	{
+		for (size_t frame = 0; frame < movie.buttons.size(); ++frame)
+		{
+			core.bus.pad.set_buttons(movie.frame_buttons(frame));
+			core.tick_until_vblank();
+		}
+		return hash_state(core);
+	}
+
+	bool movie()
+	{
+		auto core = boot_test_rom();
+		if (!core)
+			return false;
+
+		// one movie from the middle of a run, one from power on
+		run_frames(*core, 0, 10);
+		Movie from_state = Movie::start_recording(*core, false);
+		for (uint32_t frame = 10; frame < 70; ++frame)
+			from_state.buttons.push_back(static_cast<uint8_t>(frame * 37));
+		const uint64_t from_state_hash = play_movie(*core, from_state);
+
+		Movie from_power_on = Movie::start_recording(*core, true);
+		from_power_on.buttons.assign(200, 0);
+		from_power_on.buttons[120] = 0x08;
+		const uint64_t from_power_on_hash = play_movie(*core, from_power_on);
+
+		bool ok = true;
+		const std::string path = (std::filesystem::temp_directory_path() / "nesterpiece_core_test.movie").string();
+		for (const auto &[recorded, hash] : {std::pair{&from_state, from_state_hash}, std::pair{&from_power_on, from_power_on_hash}})
+		{
+			ok &= expect(recorded->save(path), "a movie saves");
+			const auto loaded = Movie::load(path);
+			if (!expect(loaded.has_value(), "a saved movie loads"))
+				return false;
+
+			ok &= expect(loaded->rom_hash == recorded->rom_hash && loaded->start_state == recorded->start_state && loaded->buttons == recorded->buttons,
+						 "a movie loads as it was saved");
+
+			// played back on a machine that has been running something else
+			auto player = boot_test_rom();
+			run_frames(*player, 0, 25);
+			ok &= expect(loaded->start_playback(*player), "a movie plays on its rom");
+			ok &= expect(play_movie(*player, *loaded) == hash, "playback ends where the recording did");
+		}
+
+		// every cut short file is rejected, whether it ends in the header, the state or the input
+		from_state.save(path);
+		std::vector<char> data(std::filesystem::file_size(path));
+		std::ifstream(path, std::ios::binary).read(data.data(), data.size());
+		for (const size_t size : {size_t(0), size_t(10), size_t(100), data.size() - 1})
+		{
+			std::ofstream(path, std::ios::binary | std::ios::trunc).write(data.data(), size);
+			ok &= expect(!Movie::load(path), "a truncated movie is rejected");
+		}
+		std::filesystem::remove(path);
+
+		auto rom = std::make_shared<RomImage>(*core->bus.cart->rom);
+		rom->prg_rom[0] ^= 1;
+		auto other = std::make_unique<Core>();
+		other->reset(Cartridge::from_image(rom));
+		ok &= expect(!from_state.start_playback(*other), "a movie doesn't play on another rom");
+		return ok;
+	}
+
+	bool run_until()
+	{
+		auto core = boot_test_rom();
+		if (!core)
+			return false;
+
+		run_frames(*core, 0, 10);
+		bool ok = true;
+
+		RunResult run = core->run_until({});
+		ok &= expect(run.reason == StopReason::None && run.instructions == 0, "nothing runs without a condition");
+		run = core->run_until({.scanline_dot = std::make_pair(uint16_t(262), uint16_t(0))});
+		ok &= expect(run.reason == StopReason::None && run.cycles == 0, "a scanline past 261 is rejected");
+		run = core->run_until({.scanline_dot = std::make_pair(uint16_t(0), uint16_t(341))});
+		ok &= expect(run.reason == StopReason::None && run.cycles == 0, "a dot past 340 is rejected");
+
+		// a condition met in the middle of an instruction stops after it
+		run = core->run_until({.cycles = 1000});
+		ok &= expect(run.reason == StopReason::CycleBudget && run.cycles >= 1000 && run.cycles < 1008, "the cycle budget stops the run");
+
+		// the cpu takes an interrupt together with the first instruction of its handler, the
+		// nmi handler's second one (txa) is the first that can be the next instruction
+		const auto &prg = core->bus.cart->rom->prg_rom;
+		const uint16_t handler = (prg[prg.size() - 6] | (prg[prg.size() - 5] << 8)) + 1;
+		run = core->run_until({.pc = handler});
+		ok &= expect(run.reason == StopReason::PC && core->cpu.registers.pc == handler, "reaching the pc stops the run");
+
+		run = core->run_until({.write_range = std::make_pair(uint16_t(0x0300), uint16_t(0x0300))});
+		ok &= expect(run.reason == StopReason::MemoryWrite && run.write_address == 0x0300 && run.write_value == core->bus.internal_ram[0x12],
+					 "a write in the range stops the run");
+
+		run = core->run_until({.scanline_dot = std::make_pair(uint16_t(100), uint16_t(200))});
+		ok &= expect(run.reason == StopReason::ScanlineDot && core->ppu.scanline_num == 100 && core->ppu.cycles >= 200 && core->ppu.cycles < 200 + (8 * 3),
+					 "reaching the scanline and dot stops the run");
+
+		run = core->run_until({.frames = 3});
+		ok &= expect(run.reason == StopReason::Frames && run.frames == 3 && core->ppu.scanline_num == 241, "the frame count stops the run");
+
+		// the first condition met wins
+		run = core->run_until({.cycles = 100, .frames = 1});
+		ok &= expect(run.reason == StopReason::CycleBudget && run.frames == 0, "the earlier of two conditions stops the run");
+		return ok;
+	}
+
+	struct TestCase
+	{
+		std::string_view name;
+		bool (*run)();
+	};
+
+	constexpr std::array tests{
+		TestCase{"scheduler", scheduler},
+		TestCase{"sprite_priority", sprite_priority},
+		TestCase{"save_state", save_state},
+		TestCase{"rewind", rewind},
+		TestCase{"clone", clone},
+		TestCase{"movie", movie},
+		TestCase{"run_until", run_until},
+	};
+}
+
+// runs the test named on the command line, or every test
+int main(int argc, char **argv)
+{
+	const std::string_view selected = argc > 1 ? argv[1] : "";
+	bool found = false, failed = false;
+	for (const auto &test : tests)
+	{
+		if (!selected.empty() && test.name != selected)
+			continue;
+
+		found = true;
+		const bool passed = test.run();
+		fmt::print("{}: {}\n", test.name, passed ? "passed" : "failed");
+		failed |= !passed;
+	}
+
+	if (!found)
+	{
+		fmt::print("No test named {}.\n", selected);
+		return 1;
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+# writes test.nes, the 16 KiB NROM image the core tests run against.
+#
+# the program turns on rendering and nmi, then every frame:
+#   nmi:  oam dma from $0200, reads the pad into $10, counts nmis in $14
+#   main: adds the buttons into $12 and writes that to $0300, moves sprite 0 right by
+#         the buttons and counts frames in $13
+# the top half of the background is opaque, the bottom half transparent. oam 1 (behind
+# the background) and oam 2 (in front) overlap at x 100 in each half, as do oam 3 and 4
+import struct
+
+ORG = 0xC000
+code = []
+labels = {}
+fixups = []
+
+
+def here():
+    return ORG + len(code)
+
+
+def label(name):
+    labels[name] = here()
+
+
+def emit(*values):
+    code.extend(values)
+
+
+def absolute(opcode, name):
+    emit(opcode, 0, 0)
+    fixups.append(('abs', len(code) - 2, name))
+
+
+def branch(opcode, name):
+    emit(opcode, 0)
+    fixups.append(('rel', len(code) - 1, name))
+
+
+def lda_i(v): emit(0xA9, v)
+def ldx_i(v): emit(0xA2, v)
+def cpx_i(v): emit(0xE0, v)
+def sta(a): emit(0x8D, a & 0xFF, a >> 8)
+def sta_zp(a): emit(0x85, a)
+def lda_zp(a): emit(0xA5, a)
+def inc_zp(a): emit(0xE6, a)
+def bit(a): emit(0x2C, a & 0xFF, a >> 8)
+
+
+BPL, BNE, BEQ = 0x10, 0xD0, 0xF0
+
+label('reset')
+emit(0x78, 0xD8)                 # sei, cld
+ldx_i(0xFF); emit(0x9A)          # txs
+lda_i(0); sta(0x2000); sta(0x2001)
+label('vblank1'); bit(0x2002); branch(BPL, 'vblank1')
+label('vblank2'); bit(0x2002); branch(BPL, 'vblank2')
+
+lda_i(0x3F); sta(0x2006); lda_i(0); sta(0x2006)
+ldx_i(0)
+label('palette_loop'); absolute(0xBD, 'palette'); sta(0x2007); emit(0xE8); cpx_i(32); branch(BNE, 'palette_loop')
+
+# 480 opaque tiles, then 480 transparent ones and the attribute table
+lda_i(0x20); sta(0x2006); lda_i(0); sta(0x2006)
+lda_i(0xFE)
+for n, count in enumerate((240, 240)):
+    ldx_i(count); label(f'opaque{n}'); sta(0x2007); emit(0xCA); branch(BNE, f'opaque{n}')
+lda_i(0)
+for n, count in enumerate((0, 0, 32)):
+    ldx_i(count); label(f'clear{n}'); sta(0x2007); emit(0xCA); branch(BNE, f'clear{n}')
+
+ldx_i(0); lda_i(0xF0)
+label('hide_sprites'); emit(0x9D, 0x00, 0x02); emit(0xE8); branch(BNE, 'hide_sprites')
+ldx_i(0)
+label('copy_sprites'); absolute(0xBD, 'sprites'); emit(0x9D, 0x00, 0x02); emit(0xE8); cpx_i(20); branch(BNE, 'copy_sprites')
+
+lda_i(0); sta(0x2005); sta(0x2005)
+lda_i(0x1E); sta(0x2001)
+lda_i(0x80); sta(0x2000)
+
+label('main')
+lda_zp(0x11); branch(BEQ, 'main')
+lda_i(0); sta_zp(0x11)
+lda_zp(0x10); emit(0x18); emit(0x65, 0x12); sta_zp(0x12)   # clc, adc $12
+sta(0x0300)
+emit(0xAD, 0x03, 0x02); emit(0x18); emit(0x65, 0x10); sta(0x0203)
+inc_zp(0x13)
+absolute(0x4C, 'main')
+
+label('nmi')
+emit(0x48, 0x8A, 0x48)           # pha, txa, pha
+lda_i(0x02); sta(0x4014)
+lda_i(1); sta(0x4016); lda_i(0); sta(0x4016)
+ldx_i(8)
+label('read_pad'); emit(0xAD, 0x16, 0x40); emit(0x4A); emit(0x66, 0x10); emit(0xCA); branch(BNE, 'read_pad')
+inc_zp(0x11); inc_zp(0x14)
+lda_i(0); sta(0x2005); sta(0x2005)
+emit(0x68, 0xAA, 0x68, 0x40)     # pla, tax, pla, rti
+
+label('irq')
+emit(0x40)
+
+label('palette')
+emit(0x0F, 0x16, 0x27, 0x30, 0x0F, 0x06, 0x17, 0x28, 0x0F, 0x0A, 0x1A, 0x2A, 0x0F, 0x0C, 0x1C, 0x2C)
+emit(0x0F, 0x14, 0x24, 0x34, 0x0F, 0x11, 0x21, 0x31, 0x0F, 0x19, 0x29, 0x39, 0x0F, 0x15, 0x25, 0x35)
+
+label('sprites')
+emit(20, 0x01, 0x00, 16)
+emit(60, 0xFF, 0x21, 100)
+emit(60, 0xFF, 0x02, 100)
+emit(180, 0xFF, 0x21, 100)
+emit(180, 0xFF, 0x02, 100)
+
+for kind, offset, name in fixups:
+    target = labels[name]
+    if kind == 'abs':
+        code[offset] = target & 0xFF
+        code[offset + 1] = target >> 8
+    else:
+        distance = target - (ORG + offset + 1)
+        assert -128 <= distance < 128, name
+        code[offset] = distance & 0xFF
+
+prg = bytearray(0x4000)
+prg[:len(code)] = bytes(code)
+for vector, name in ((0x3FFA, 'nmi'), (0x3FFC, 'reset'), (0x3FFE, 'irq')):
+    prg[vector:vector + 2] = struct.pack('<H', labels[name])
+
+chr_rom = bytearray(0x2000)
+chr_rom[0x10:0x20] = bytes([0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C] + [0x00, 0x3C, 0x7E, 0x7E, 0x7E, 0x7E, 0x3C, 0x00])
+chr_rom[0xFE0:0xFF0] = bytes([0xFF] * 8 + [0x00] * 8)
+chr_rom[0xFF0:0x1000] = bytes([0xFF] * 16)
+
+header = b'NES\x1a' + bytes([1, 1, 0, 0]) + bytes(8)
+with open('test.nes', 'wb') as rom:
+    rom.write(header + prg + chr_rom)
+
+print('nmi', hex(labels['nmi']), 'main', hex(labels['main']))
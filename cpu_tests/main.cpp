@@ -1,5 +1,5 @@
-#include "bus.hpp"
 #include "../src/nes/cpu.hpp"
+#include "../src/nes/flat_bus.hpp"
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <vector>
@@ -17,8 +17,9 @@ bool test_with_json(std::string path)
 	{
 		auto jdata = json::parse(file);
 		file.close();
-		NESterpiece::CPU cpu{};
-		NESterpiece::Bus bus{};
+		NESterpiece::CPU<NESterpiece::FlatBus> cpu{};
+		NESterpiece::FlatBus bus{};
+		bus.record_activity = true;
 		for (const auto &object : jdata)
 		{
 			bool test_failed = false;
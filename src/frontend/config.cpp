@@ -90,6 +90,11 @@ namespace NESterpiece
 	{
 		emulation.allow_sram_saving = emulation_table["allow_sram_saving"].value_or(emulation.allow_sram_saving);
 		emulation.sram_save_interval = emulation_table["sram_save_interval"].value_or(emulation.sram_save_interval);
+		emulation.allow_rewind = emulation_table["allow_rewind"].value_or(emulation.allow_rewind);
+		emulation.rewind_buffer_size = emulation_table["rewind_buffer_size"].value_or(emulation.rewind_buffer_size);
+		emulation.rewind_key = SDL_GetScancodeFromName(emulation_table["rewind_key"].value_or(SDL_GetScancodeName(emulation.rewind_key)));
+		emulation.run_ahead_frames = std::min(emulation_table["run_ahead_frames"].value_or(emulation.run_ahead_frames), 4u);
+		emulation.speculative_run_ahead = emulation_table["speculative_run_ahead"].value_or(emulation.speculative_run_ahead);
 	}
 
 	toml::table Configuration::emulation_settings_as_toml() const
@@ -97,6 +102,11 @@ namespace NESterpiece
 		return toml::table{
 			{"allow_sram_saving", emulation.allow_sram_saving},
 			{"sram_save_interval", emulation.sram_save_interval},
+			{"allow_rewind", emulation.allow_rewind},
+			{"rewind_buffer_size", emulation.rewind_buffer_size},
+			{"rewind_key", SDL_GetScancodeName(emulation.rewind_key)},
+			{"run_ahead_frames", emulation.run_ahead_frames},
+			{"speculative_run_ahead", emulation.speculative_run_ahead},
 		};
 	}
 
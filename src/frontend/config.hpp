@@ -19,6 +19,14 @@ namespace NESterpiece
 		{
 			bool allow_sram_saving = true;
 			uint32_t sram_save_interval = 15;
+			bool allow_rewind = true;
+			// MiB of history to keep
+			uint32_t rewind_buffer_size = 64;
+			SDL_Scancode rewind_key = SDL_SCANCODE_BACKSPACE;
+			// frames emulated ahead of the one shown to hide the game's input lag, 0 to 4
+			uint32_t run_ahead_frames = 0;
+			// run ahead on a second thread instead of repeating frames on the emulation thread
+			bool speculative_run_ahead = false;
 		} emulation;
 
 		struct
@@ -0,0 +1,332 @@
+#include "emulation_thread.hpp"
+#include "gui_constants.hpp"
+#include <nes/cartridge.hpp>
+#include <chrono>
+
+namespace NESterpiece
+{
+	EmulationThread::EmulationThread()
+	{
+		core.ppu.update_event = SnapshotEvent::OnScanlineCycle;
+		core.ppu.trigger_cycle = 0;
+		core.ppu.trigger_scanline = 0;
+		core.bus.pad.input_poll_cb = [this](StdController &pad)
+		{
+			pad.set_buttons(frame_buttons);
+		};
+	}
+
+	EmulationThread::~EmulationThread()
+	{
+		stop();
+	}
+
+	void EmulationThread::start()
+	{
+		if (worker.joinable())
+			return;
+
+		quit.store(false, std::memory_order_relaxed);
+		speculative_core.start();
+		worker = std::thread([this]()
+							 { run(); });
+	}
+
+	void EmulationThread::stop()
+	{
+		if (!worker.joinable())
+			return;
+
+		quit.store(true, std::memory_order_relaxed);
+		worker.join();
+		speculative_core.stop();
+	}
+
+	bool EmulationThread::send(EmulationCommand command)
+	{
+		return commands.push(std::move(command));
+	}
+
+	void EmulationThread::update_settings(const EmulationSettings &new_settings)
+	{
+		settings.back() = new_settings;
+		settings.publish();
+	}
+
+	void EmulationThread::set_pad_buttons(uint8_t buttons)
+	{
+		pad_buttons.store(buttons, std::memory_order_relaxed);
+	}
+
+	void EmulationThread::set_rewinding(bool held)
+	{
+		rewinding.store(held, std::memory_order_relaxed);
+	}
+
+	bool EmulationThread::is_recording() const
+	{
+		return recording_movie.load(std::memory_order_relaxed);
+	}
+
+	bool EmulationThread::is_playing_movie() const
+	{
+		return playing_movie.load(std::memory_order_relaxed);
+	}
+
+	bool EmulationThread::acquire_frame()
+	{
+		showing_speculative = show_speculative.load(std::memory_order_relaxed);
+		return showing_speculative ? speculative_core.acquire_frame() : frames.acquire();
+	}
+
+	bool EmulationThread::acquire_snapshot()
+	{
+		return snapshots.acquire();
+	}
+
+	const Frame &EmulationThread::frame() const
+	{
+		return showing_speculative ? speculative_core.frame_output() : frames.front();
+	}
+
+	const PPUSnapshot &EmulationThread::snapshot() const
+	{
+		return snapshots.front();
+	}
+
+	void EmulationThread::run()
+	{
+		using namespace std::chrono_literals;
+		constexpr std::chrono::nanoseconds max_step_delay = 33ms;
+		constexpr auto logic_rate = set_update_frequency_hz(60);
+		auto next_frame = std::chrono::steady_clock::now();
+
+		while (!quit.load(std::memory_order_relaxed))
+		{
+			if (settings.acquire())
+				apply_settings(settings.front());
+			while (auto command = commands.pop())
+				execute(*command);
+
+			if (running && !paused)
+			{
+				if (rewinding.load(std::memory_order_relaxed) && !recording && !playback)
+					step_back();
+				else
+					step_forward();
+
+				publish_snapshot();
+			}
+
+			next_frame += logic_rate;
+			const auto time_now = std::chrono::steady_clock::now();
+
+			// after a long stall start over instead of racing to catch up
+			if (time_now - next_frame > max_step_delay)
+				next_frame = time_now;
+
+			std::this_thread::sleep_until(next_frame);
+		}
+	}
+
+	void EmulationThread::execute(EmulationCommand &command)
+	{
+		switch (command.type)
+		{
+		case EmulationCommandType::Load:
+			finish_recording();
+			stop_playback();
+			++timeline;
+			rewind.clear();
+			core.reset(std::move(command.cart));
+			running = true;
+			paused = false;
+			break;
+		case EmulationCommandType::Reset:
+			if (core.bus.cart)
+			{
+				finish_recording();
+				stop_playback();
+				++timeline;
+				rewind.clear();
+				core.reset(core.bus.cart);
+				running = true;
+				paused = false;
+			}
+			break;
+		case EmulationCommandType::SetPaused:
+			paused = command.paused;
+			break;
+		case EmulationCommandType::Stop:
+			finish_recording();
+			stop_playback();
+			running = false;
+			rewind.clear();
+			break;
+		case EmulationCommandType::StartRecording:
+			if (running)
+			{
+				finish_recording();
+				stop_playback();
+				++timeline;
+				rewind.clear();
+				recording = Movie::start_recording(core, command.from_power_on);
+				recording_path = std::move(command.movie_path);
+				recording_movie.store(true, std::memory_order_relaxed);
+			}
+			break;
+		case EmulationCommandType::StopRecording:
+			finish_recording();
+			break;
+		case EmulationCommandType::PlayMovie:
+			finish_recording();
+			stop_playback();
+			if (command.movie->start_playback(core))
+			{
+				++timeline;
+				rewind.clear();
+				playback = std::move(command.movie);
+				playback_frame = 0;
+				running = true;
+				paused = false;
+				playing_movie.store(true, std::memory_order_relaxed);
+			}
+			break;
+		case EmulationCommandType::StopMovie:
+			stop_playback();
+			break;
+		}
+	}
+
+	void EmulationThread::apply_settings(const EmulationSettings &new_settings)
+	{
+		core.ppu.trigger_scanline = new_settings.trigger_scanline;
+		core.ppu.trigger_cycle = new_settings.trigger_cycle;
+		run_ahead_frames = new_settings.run_ahead_frames;
+		speculative = new_settings.speculative;
+		rewind_enabled = new_settings.rewind_enabled;
+		rewind.set_memory_budget(new_settings.rewind_budget);
+		if (!rewind_enabled)
+			rewind.clear();
+	}
+
+	void EmulationThread::step_forward()
+	{
+		if (playback)
+		{
+			frame_buttons = playback->frame_buttons(playback_frame++);
+			if (playback_frame >= playback->buttons.size())
+				stop_playback();
+		}
+		else
+		{
+			frame_buttons = pad_buttons.load(std::memory_order_relaxed);
+		}
+
+		if (recording)
+			recording->buttons.push_back(frame_buttons);
+		++timeline;
+
+		// the state from before the frame, so stepping back can redraw it
+		if (rewind_enabled)
+		{
+			core.save_state(rewind_state);
+			rewind.push(rewind_state, frame_buttons);
+		}
+
+		if (run_ahead_frames != 0 && speculative)
+		{
+			run_ahead_speculatively();
+			return;
+		}
+
+		show_speculative.store(false, std::memory_order_relaxed);
+		core.ppu.output_enabled = true;
+		if (run_ahead_frames == 0)
+			core.tick_until_vblank();
+		else
+			run_ahead();
+		publish_frame();
+	}
+
+	void EmulationThread::run_ahead()
+	{
+		// run the real frame and the ones after it unseen with the current input, show the
+		// last one and go back to where the real frame ended
+		core.ppu.output_enabled = false;
+		core.tick_until_vblank();
+		core.save_state(run_ahead_state);
+		for (uint32_t i = 1; i < run_ahead_frames; ++i)
+			core.tick_until_vblank();
+
+		core.ppu.output_enabled = true;
+		core.tick_until_vblank();
+		core.load_state(run_ahead_state.data(), run_ahead_state.size());
+	}
+
+	void EmulationThread::run_ahead_speculatively()
+	{
+		// the real frame is never shown, the speculative core continues from it
+		core.ppu.output_enabled = false;
+		core.tick_until_vblank();
+
+		auto &request = speculative_core.next_request();
+		core.save_state(request.state);
+		request.rom = core.bus.cart->rom;
+		request.frame = timeline;
+		request.buttons = frame_buttons;
+		request.frames_ahead = run_ahead_frames;
+		speculative_core.submit();
+		show_speculative.store(true, std::memory_order_relaxed);
+	}
+
+	void EmulationThread::step_back()
+	{
+		// the newest entry is from before the frame on screen. drop it and redraw the one
+		// before with the buttons it had, which leaves the machine right after that frame
+		// and its entry on top for the next step
+		if (rewind.size() < 2)
+			return;
+
+		rewind.pop();
+		if (!rewind.peek(rewind_state, frame_buttons) || !core.load_state(rewind_state.data(), rewind_state.size()))
+			return;
+
+		++timeline;
+		show_speculative.store(false, std::memory_order_relaxed);
+		core.ppu.output_enabled = true;
+
+		// frames aren't part of a state, run the restored frame again to show it
+		core.tick_until_vblank();
+		publish_frame();
+	}
+
+	void EmulationThread::finish_recording()
+	{
+		if (!recording)
+			return;
+
+		recording->save(recording_path);
+		recording.reset();
+		recording_movie.store(false, std::memory_order_relaxed);
+	}
+
+	void EmulationThread::stop_playback()
+	{
+		playback.reset();
+		playing_movie.store(false, std::memory_order_relaxed);
+	}
+
+	// the core draws into a single frame, the ui gets a copy of it once it's finished
+	void EmulationThread::publish_frame()
+	{
+		frames.back() = core.ppu.frame;
+		frames.publish();
+	}
+
+	void EmulationThread::publish_snapshot()
+	{
+		snapshots.back() = core.ppu.snapshot;
+		snapshots.publish();
+	}
+}
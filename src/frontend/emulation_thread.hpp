@@ -0,0 +1,128 @@
+#pragma once
+#include "speculative_core.hpp"
+#include <nes/core.hpp>
+#include <nes/spsc_queue.hpp>
+#include <nes/triple_buffer.hpp>
+#include <nes/rewind.hpp>
+#include <nes/movie.hpp>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+namespace NESterpiece
+{
+	enum class EmulationCommandType
+	{
+		Load,
+		Reset,
+		SetPaused,
+		Stop,
+		StartRecording,
+		StopRecording,
+		PlayMovie,
+		StopMovie,
+	};
+
+	struct EmulationCommand
+	{
+		EmulationCommandType type = EmulationCommandType::Reset;
+		std::shared_ptr<Cartridge> cart;
+		bool paused = false;
+		// recordings are written to movie_path when they stop
+		std::string movie_path;
+		bool from_power_on = false;
+		std::shared_ptr<const Movie> movie;
+	};
+
+	// options the ui can change every frame while a slider is dragged. only the newest
+	// matters, so they go through a single slot instead of the command queue
+	struct EmulationSettings
+	{
+		uint16_t trigger_scanline = 0, trigger_cycle = 0;
+		bool rewind_enabled = false;
+		size_t rewind_budget = 0;
+		uint32_t run_ahead_frames = 0;
+		bool speculative = false;
+
+		bool operator==(const EmulationSettings &) const = default;
+	};
+
+	// runs the core on its own thread, paced at 60hz independently of the ui.
+	// the ui thread sends commands and pad state in, frames and ppu snapshots come
+	// back out through triple buffers so neither side ever blocks on the other
+	class EmulationThread
+	{
+		Core core;
+		SPSCQueue<EmulationCommand, 32> commands;
+		TripleBuffer<EmulationSettings> settings;
+		TripleBuffer<Frame> frames;
+		TripleBuffer<PPUSnapshot> snapshots;
+		std::atomic<uint8_t> pad_buttons = 0;
+		std::atomic<bool> rewinding = false;
+		// set while the picture comes from the speculative core
+		std::atomic<bool> show_speculative = false;
+		std::atomic<bool> quit = false;
+		std::atomic<bool> recording_movie = false, playing_movie = false;
+		std::thread worker;
+		SpeculativeCore speculative_core;
+
+		// only touched by the worker
+		bool running = false, paused = false;
+		bool rewind_enabled = false;
+		RewindBuffer rewind;
+		std::vector<uint8_t> rewind_state;
+		uint32_t run_ahead_frames = 0;
+		std::vector<uint8_t> run_ahead_state;
+		bool speculative = false;
+		// buttons for the current frame, read once when it starts
+		uint8_t frame_buttons = 0;
+		// counts real frames, skips a number whenever the machine jumps elsewhere
+		uint64_t timeline = 0;
+		std::optional<Movie> recording;
+		std::string recording_path;
+		std::shared_ptr<const Movie> playback;
+		size_t playback_frame = 0;
+
+		// only touched by the ui thread
+		bool showing_speculative = false;
+
+	public:
+		EmulationThread();
+		EmulationThread(const EmulationThread &) = delete;
+		EmulationThread(EmulationThread &&) = delete;
+		~EmulationThread();
+		EmulationThread &operator=(const EmulationThread &) = delete;
+		EmulationThread &operator=(EmulationThread &&) = delete;
+
+		void start();
+		void stop();
+		// false when the queue is full and the command was dropped
+		[[nodiscard]] bool send(EmulationCommand command);
+		void update_settings(const EmulationSettings &new_settings);
+		void set_pad_buttons(uint8_t buttons);
+		// while set the game runs backwards one frame at a time
+		void set_rewinding(bool held);
+		// a movie is one unbroken line of input, rewinding is ignored while one records or plays
+		bool is_recording() const;
+		bool is_playing_movie() const;
+
+		// ui thread only, each returns false when nothing new was published
+		bool acquire_frame();
+		bool acquire_snapshot();
+		const Frame &frame() const;
+		const PPUSnapshot &snapshot() const;
+
+	private:
+		void run();
+		void execute(EmulationCommand &command);
+		void apply_settings(const EmulationSettings &new_settings);
+		void step_forward();
+		void step_back();
+		void run_ahead();
+		void run_ahead_speculatively();
+		void publish_frame();
+		void publish_snapshot();
+		void finish_recording();
+		void stop_playback();
+	};
+}
@@ -47,19 +47,13 @@ int main(int argc, char **argv)
 	ImGui_ImplSDLRenderer2_Init(renderer);
 
 	bool running = true;
-	constexpr std::chrono::nanoseconds max_step_delay = 33ms;
-	constexpr auto logic_rate = set_update_frequency_hz(60);
-	auto accumulator = 0ns;
-	auto old_time = std::chrono::steady_clock::now();
 
 	MenuController menu;
 	auto &config = Configuration::get();
 	EmulationState state{window};
 
 	state.initialize(renderer);
-	state.core.ppu.update_event = SnapshotEvent::OnScanlineCycle;
-	state.core.ppu.trigger_cycle = 0;
-	state.core.ppu.trigger_scanline = 0;
+	state.emulation.start();
 	ControllerHandler::open();
 	while (running && !menu.menu_bar.ready_to_exit)
 	{
@@ -96,25 +90,8 @@ int main(int argc, char **argv)
 			}
 		}
 
-		auto time_now = std::chrono::steady_clock::now();
-		auto full_delta = time_now - old_time;
-		old_time = time_now;
-
-		if (full_delta > max_step_delay)
-			full_delta = max_step_delay;
-
-		accumulator += full_delta;
-
 		state.poll_input();
 
-		if (accumulator >= logic_rate)
-		{
-			if (state.status == NESterpiece::Status::Running)
-				state.step_frame();
-
-			accumulator -= logic_rate;
-		}
-
 		SDL_RenderClear(renderer);
 
 		if (state.status == NESterpiece::Status::Running)
@@ -130,6 +107,7 @@ int main(int argc, char **argv)
 		ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
 		SDL_RenderPresent(renderer);
 	}
+	state.emulation.stop();
 	ControllerHandler::close();
 	config.save_as_toml_file();
 
@@ -17,13 +17,17 @@ namespace NESterpiece
 			SetNextItemWidth(100);
 			uint16_t step = 1;
 			uint16_t stepf = 10;
-			InputScalar("Refresh on Scanline", ImGuiDataType_U16, &state.core.ppu.trigger_scanline, &step, &stepf);
+			bool trigger_changed = InputScalar("Refresh on Scanline", ImGuiDataType_U16, &state.trigger_scanline, &step, &stepf);
 			SetNextItemWidth(100);
-			InputScalar("Refresh on Cycle", ImGuiDataType_U16, &state.core.ppu.trigger_cycle, &step, &stepf);
+			trigger_changed |= InputScalar("Refresh on Cycle", ImGuiDataType_U16, &state.trigger_cycle, &step, &stepf);
+			if (trigger_changed)
+				state.update_snapshot_trigger();
+
+			state.emulation.acquire_snapshot();
 
 			if (BeginTable("PPU Registers Tbl", 2, ImGuiTableFlags_SizingFixedFit, ImVec2(320, 0)))
 			{
-				const auto &ppu = state.core.ppu.snapshot;
+				const auto &ppu = state.emulation.snapshot();
 				{
 					TableNextColumn();
 					Text("Frame Num");
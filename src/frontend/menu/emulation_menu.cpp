@@ -34,6 +34,18 @@ namespace NESterpiece
 			InputInt("Save Interval (Seconds)", reinterpret_cast<int32_t *>(&config.emulation.sram_save_interval), 5, 100, config.emulation.allow_sram_saving ? 0 : ImGuiInputTextFlags_ReadOnly);
 			TableNextRow();
 			TableNextColumn();
+			Checkbox("Allow Rewind", &config.emulation.allow_rewind);
+			TableNextColumn();
+			SetNextItemWidth(100);
+			InputInt("Rewind Buffer (MB)", reinterpret_cast<int32_t *>(&config.emulation.rewind_buffer_size), 16, 64, config.emulation.allow_rewind ? 0 : ImGuiInputTextFlags_ReadOnly);
+			TableNextRow();
+			TableNextColumn();
+			SetNextItemWidth(100);
+			SliderInt("Run-ahead Frames", reinterpret_cast<int32_t *>(&config.emulation.run_ahead_frames), 0, 4);
+			TableNextColumn();
+			Checkbox("Run Ahead on Second Thread", &config.emulation.speculative_run_ahead);
+			TableNextRow();
+			TableNextColumn();
 			EndTable();
 		}
 	}
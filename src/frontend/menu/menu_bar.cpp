@@ -91,11 +91,41 @@ namespace NESterpiece
 				state.toggle_pause();
 
 			if (MenuItem("Stop"))
+				state.stop();
+
+			Separator();
+			TextColored(MENU_TEXT_DARK, "Movie");
+			Spacing();
+			const bool running = state.status == Status::Running;
+			const bool recording = state.emulation.is_recording();
+			const bool playing = state.emulation.is_playing_movie();
+			if (MenuItem("Record from Power On", nullptr, false, running && !recording))
+			{
+				NFD::UniquePath out_path;
+				if (NFD::SaveDialog(out_path) == nfdresult_t::NFD_OKAY)
+					state.start_recording(out_path.get(), true);
+			}
+
+			if (MenuItem("Record from Here", nullptr, false, running && !recording))
 			{
-				state.status = Status::Stopped;
-				state.cart.reset();
+				NFD::UniquePath out_path;
+				if (NFD::SaveDialog(out_path) == nfdresult_t::NFD_OKAY)
+					state.start_recording(out_path.get(), false);
 			}
 
+			if (MenuItem("Stop Recording", nullptr, false, recording))
+				state.stop_recording();
+
+			if (MenuItem("Play", nullptr, false, running))
+			{
+				NFD::UniquePath out_path;
+				if (NFD::OpenDialog(out_path) == nfdresult_t::NFD_OKAY)
+					state.play_movie(out_path.get());
+			}
+
+			if (MenuItem("Stop Playback", nullptr, false, playing))
+				state.stop_movie();
+
 			EndMenu();
 		}
 	}
@@ -0,0 +1,106 @@
+#include "speculative_core.hpp"
+
+namespace NESterpiece
+{
+	SpeculativeCore::~SpeculativeCore()
+	{
+		stop();
+	}
+
+	void SpeculativeCore::start()
+	{
+		if (worker.joinable())
+			return;
+
+		quit.store(false, std::memory_order_relaxed);
+		worker = std::thread([this]()
+							 { run(); });
+	}
+
+	void SpeculativeCore::stop()
+	{
+		if (!worker.joinable())
+			return;
+
+		quit.store(true, std::memory_order_relaxed);
+		sequence.fetch_add(1, std::memory_order_release);
+		sequence.notify_one();
+		worker.join();
+	}
+
+	SpeculativeCore::Request &SpeculativeCore::next_request()
+	{
+		return requests.back();
+	}
+
+	void SpeculativeCore::submit()
+	{
+		requests.publish();
+		sequence.fetch_add(1, std::memory_order_release);
+		sequence.notify_one();
+	}
+
+	bool SpeculativeCore::acquire_frame()
+	{
+		return frames.acquire();
+	}
+
+	const Frame &SpeculativeCore::frame_output() const
+	{
+		return frames.front();
+	}
+
+	void SpeculativeCore::run()
+	{
+		uint64_t seen = 0;
+		while (true)
+		{
+			sequence.wait(seen, std::memory_order_acquire);
+			seen = sequence.load(std::memory_order_acquire);
+			if (quit.load(std::memory_order_relaxed))
+				return;
+
+			// only the newest request matters, a skipped one just means starting over
+			if (requests.acquire())
+				speculate(requests.front());
+		}
+	}
+
+	void SpeculativeCore::speculate(const Request &request)
+	{
+		const bool prediction_held = synced && request.frame == frame + 1 && request.buttons == buttons &&
+									 request.frames_ahead == frames_ahead && core.bus.cart->rom == request.rom;
+		frame = request.frame;
+		buttons = request.buttons;
+		frames_ahead = request.frames_ahead;
+
+		if (prediction_held)
+		{
+			core.tick_until_vblank();
+			publish_frame();
+			return;
+		}
+
+		if (!synced || core.bus.cart->rom != request.rom)
+			core.reset(Cartridge::from_image(request.rom));
+
+		synced = core.load_state(request.state.data(), request.state.size());
+		if (!synced)
+			return;
+
+		core.bus.pad.set_buttons(buttons);
+		core.ppu.output_enabled = false;
+		for (uint32_t i = 1; i < frames_ahead; ++i)
+			core.tick_until_vblank();
+
+		core.ppu.output_enabled = true;
+		core.tick_until_vblank();
+		publish_frame();
+	}
+
+	void SpeculativeCore::publish_frame()
+	{
+		frames.back() = core.ppu.frame;
+		frames.publish();
+	}
+}
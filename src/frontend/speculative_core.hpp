@@ -0,0 +1,68 @@
+#pragma once
+#include <nes/core.hpp>
+#include <nes/cartridge.hpp>
+#include <nes/triple_buffer.hpp>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+namespace NESterpiece
+{
+	// a second core kept a few frames ahead of the real one on its own thread, betting that
+	// the buttons stay as they are. while they do it runs one frame per real frame, a
+	// change of input or a jump of the real machine makes it start over from its state
+	class SpeculativeCore
+	{
+	public:
+		struct Request
+		{
+			// the real machine right after the frame
+			std::vector<uint8_t> state;
+			std::shared_ptr<const RomImage> rom;
+			// consecutive for consecutive real frames
+			uint64_t frame = 0;
+			uint8_t buttons = 0;
+			uint32_t frames_ahead = 0;
+		};
+
+	private:
+		Core core;
+		TripleBuffer<Request> requests;
+		// the core's picture after each speculated frame
+		TripleBuffer<Frame> frames;
+		std::atomic<uint64_t> sequence = 0;
+		std::atomic<bool> quit = false;
+		std::thread worker;
+
+		// only touched by the worker, what the core's current frame is based on
+		bool synced = false;
+		uint64_t frame = 0;
+		uint8_t buttons = 0;
+		uint32_t frames_ahead = 0;
+
+	public:
+		SpeculativeCore() = default;
+		SpeculativeCore(const SpeculativeCore &) = delete;
+		SpeculativeCore(SpeculativeCore &&) = delete;
+		~SpeculativeCore();
+		SpeculativeCore &operator=(const SpeculativeCore &) = delete;
+		SpeculativeCore &operator=(SpeculativeCore &&) = delete;
+
+		void start();
+		void stop();
+
+		// emulation thread only, fill in next_request() then submit() it
+		Request &next_request();
+		void submit();
+
+		// ui thread only
+		bool acquire_frame();
+		const Frame &frame_output() const;
+
+	private:
+		void run();
+		void speculate(const Request &request);
+		void publish_frame();
+	};
+}
@@ -2,6 +2,7 @@
 #include "config.hpp"
 #include <nes/constants.hpp>
 #include <nes/cartridge.hpp>
+#include <nes/movie.hpp>
 #include <SDL.h>
 #include <cmath>
 namespace NESterpiece
@@ -14,6 +15,7 @@ namespace NESterpiece
 	EmulationState::~EmulationState()
 	{
 		_window = nullptr;
+		emulation.stop();
 		close();
 	}
 
@@ -38,7 +40,32 @@ namespace NESterpiece
 
 	void EmulationState::create_texture(SDL_Renderer *renderer)
 	{
-		texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+		// prefer a format the renderer supports natively so the driver doesn't have to swizzle
+		uint32_t format = SDL_PIXELFORMAT_RGBA8888;
+		SDL_RendererInfo info{};
+		if (SDL_GetRendererInfo(renderer, &info) == 0)
+		{
+			for (uint32_t i = 0; i < info.num_texture_formats; ++i)
+			{
+				const uint32_t candidate = info.texture_formats[i];
+				if (SDL_BITSPERPIXEL(candidate) == 32 && SDL_ISPIXELFORMAT_PACKED(candidate))
+				{
+					format = candidate;
+					break;
+				}
+			}
+		}
+
+		texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+		SDL_PixelFormat *pixel_format = SDL_AllocFormat(format);
+		for (size_t i = 0; i < texture_palette.size(); ++i)
+		{
+			const uint32_t color = EmphasisPalette2C02[i];
+			texture_palette[i] = SDL_MapRGBA(pixel_format, color >> 24, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+		}
+		SDL_FreeFormat(pixel_format);
+
 		auto &config = Configuration::get();
 
 		if (config.video.linear_filtering)
@@ -60,53 +87,121 @@ namespace NESterpiece
 
 	bool EmulationState::try_play(std::string_view path)
 	{
-		cart = Cartridge::from_file(path.data());
-		auto &config = Configuration::get();
-		if (cart)
-		{
-			paused = false;
-			core.reset(cart);
-			status = Status::Running;
-			return true;
-		}
-		return false;
+		auto loaded = Cartridge::from_file(path.data());
+		if (!loaded || !emulation.send({.type = EmulationCommandType::Load, .cart = loaded}))
+			return false;
+
+		cart = std::move(loaded);
+		paused = false;
+		status = Status::Running;
+		return true;
 	}
 
 	void EmulationState::reset()
 	{
-		auto &config = Configuration::get();
-		if (cart)
+		if (cart && emulation.send({.type = EmulationCommandType::Reset}))
 		{
 			paused = false;
-			core.reset(cart);
 			status = Status::Running;
 		}
 	}
 
 	void EmulationState::toggle_pause()
 	{
-		if (status == Status::Running)
+		if (status == Status::Running && emulation.send({.type = EmulationCommandType::SetPaused, .paused = !paused}))
 			paused = !paused;
 	}
 
-	void EmulationState::poll_input()
+	void EmulationState::stop()
+	{
+		if (emulation.send({.type = EmulationCommandType::Stop}))
+		{
+			status = Status::Stopped;
+			cart.reset();
+		}
+	}
+
+	bool EmulationState::start_recording(std::string path, bool from_power_on)
 	{
-		core.bus.pad.reset();
-		user_input.update_state(core.bus.pad);
+		return status == Status::Running && emulation.send({.type = EmulationCommandType::StartRecording,
+															.movie_path = std::move(path),
+															.from_power_on = from_power_on});
 	}
 
-	void EmulationState::step_frame()
+	bool EmulationState::stop_recording()
 	{
-		if (status == Status::Running && !paused)
-			core.tick_until_vblank();
+		return emulation.send({.type = EmulationCommandType::StopRecording});
+	}
+
+	bool EmulationState::play_movie(std::string_view path)
+	{
+		auto movie = Movie::load(std::string(path));
+		if (!cart || !movie || movie->rom_hash != hash_rom(*cart->rom))
+			return false;
+
+		if (!emulation.send({.type = EmulationCommandType::PlayMovie,
+							 .movie = std::make_shared<const Movie>(std::move(*movie))}))
+			return false;
+
+		paused = false;
+		status = Status::Running;
+		return true;
+	}
+
+	bool EmulationState::stop_movie()
+	{
+		return emulation.send({.type = EmulationCommandType::StopMovie});
+	}
+
+	void EmulationState::update_snapshot_trigger()
+	{
+		publish_settings();
+	}
+
+	// a dragged slider changes these every frame, only the newest values are handed over
+	void EmulationState::publish_settings()
+	{
+		const auto &config = Configuration::get().emulation;
+		const EmulationSettings current{
+			.trigger_scanline = trigger_scanline,
+			.trigger_cycle = trigger_cycle,
+			.rewind_enabled = config.allow_rewind,
+			.rewind_budget = static_cast<size_t>(config.rewind_buffer_size) << 20,
+			.run_ahead_frames = config.run_ahead_frames,
+			.speculative = config.speculative_run_ahead,
+		};
+
+		if (current != settings)
+		{
+			settings = current;
+			emulation.update_settings(settings);
+		}
+	}
+
+	void EmulationState::poll_input()
+	{
+		ui_pad.reset();
+		user_input.update_state(ui_pad);
+		emulation.set_pad_buttons(ui_pad.buttons());
+		publish_settings();
+
+		const auto &config = Configuration::get().emulation;
+		const Uint8 *keyboard = SDL_GetKeyboardState(nullptr);
+		emulation.set_rewinding(settings.rewind_enabled && keyboard[config.rewind_key]);
 	}
 
 	void EmulationState::draw_frame(SDL_Window *window, SDL_Renderer *renderer)
 	{
 		if (status == Status::Running && texture)
 		{
-			const auto &framebuffer_pixels = core.ppu.framebuffer;
-			SDL_UpdateTexture(texture, nullptr, framebuffer_pixels.data(), SCREEN_WIDTH * sizeof(uint32_t));
+			// only touch the texture when the emulation thread finished a new frame
+			void *pixels = nullptr;
+			int32_t pitch = 0;
+			if (emulation.acquire_frame() && SDL_LockTexture(texture, nullptr, &pixels, &pitch) == 0)
+			{
+				emulation.frame().convert(static_cast<uint32_t *>(pixels), pitch / sizeof(uint32_t), texture_palette.data());
+				SDL_UnlockTexture(texture);
+			}
 
 			int32_t w = 0, h = 0;
 			SDL_GetWindowSize(window, &w, &h);
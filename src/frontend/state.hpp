@@ -1,9 +1,11 @@
 #pragma once
 #include "input.hpp"
+#include "emulation_thread.hpp"
 #include <nes/core.hpp>
 #include <memory>
 #include <SDL.h>
 #include <vector>
+#include <array>
 #include <string_view>
 
 namespace NESterpiece
@@ -18,12 +20,18 @@ namespace NESterpiece
 	{
 		SDL_Texture *texture = nullptr;
 		SDL_Window *_window = nullptr;
+		// EmphasisPalette2C02 mapped to the texture's pixel format
+		std::array<uint32_t, 64 * 8> texture_palette{};
+		StdController ui_pad;
+		// settings last handed to the emulation thread
+		EmulationSettings settings;
 
 	public:
 		Status status = Status::Stopped;
 		bool paused = false;
 		int32_t menu_bar_height = 0.0f;
-		Core core;
+		uint16_t trigger_scanline = 0, trigger_cycle = 0;
+		EmulationThread emulation;
 		InputHandler user_input;
 		ControllerHandler controllers;
 
@@ -45,8 +53,17 @@ namespace NESterpiece
 		bool try_play(std::string_view path);
 		void reset();
 		void toggle_pause();
+		void stop();
+		// each returns false, changing nothing, when the emulation thread's queue was full
+		bool start_recording(std::string path, bool from_power_on);
+		bool stop_recording();
+		bool play_movie(std::string_view path);
+		bool stop_movie();
+		void update_snapshot_trigger();
 		void poll_input();
-		void step_frame();
 		void draw_frame(SDL_Window *window, SDL_Renderer *renderer);
+
+	private:
+		void publish_settings();
 	};
 }
\ No newline at end of file
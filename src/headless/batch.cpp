@@ -0,0 +1,124 @@
+#include <nes/batch.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	using namespace NESterpiece;
+
+	void print_usage()
+	{
+		std::printf("usage: NESterpiece-Batch <job list> [options]\n"
+					"  --threads <n>  number of worker threads (default: one per hardware thread)\n"
+					"  --frames <n>   frames per job when its line doesn't say (default 600)\n"
+					"\n"
+					"every line of the job list is \"<rom> [input] [frames]\". the input is a movie or\n"
+					"an input script, use - for none\n");
+	}
+
+	std::optional<std::vector<BatchJob>> load_jobs(const std::string &path, uint32_t default_frames)
+	{
+		std::ifstream file(path);
+		if (!file)
+			return std::nullopt;
+
+		std::vector<BatchJob> jobs;
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream stream(line.substr(0, line.find('#')));
+			BatchJob job;
+			std::string script;
+			if (!(stream >> job.rom_path))
+				continue;
+
+			job.frames = default_frames;
+			if (stream >> script && script != "-")
+			{
+				if (auto movie = Movie::load(script))
+				{
+					job.frames = static_cast<uint32_t>(movie->buttons.size());
+					job.movie = std::make_shared<const Movie>(std::move(*movie));
+				}
+				else if (auto inputs = load_input_script(script))
+				{
+					job.inputs = std::move(*inputs);
+				}
+				else
+				{
+					std::printf("Unable to read input %s.\n", script.c_str());
+					return std::nullopt;
+				}
+			}
+			stream >> job.frames;
+			jobs.push_back(std::move(job));
+		}
+
+		return jobs;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		print_usage();
+		return 1;
+	}
+
+	uint32_t threads = 0, frames = 600;
+	for (int i = 2; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc)
+			threads = std::strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--frames" && i + 1 < argc)
+			frames = std::strtoul(argv[++i], nullptr, 10);
+		else
+		{
+			print_usage();
+			return 1;
+		}
+	}
+
+	const auto jobs = load_jobs(argv[1], frames);
+	if (!jobs)
+	{
+		std::printf("Unable to read job list.\n");
+		return 1;
+	}
+
+	uint64_t total_frames = 0;
+	uint32_t failed = 0;
+	const auto start = std::chrono::steady_clock::now();
+	BatchRunner runner(threads);
+	runner.run(*jobs, [&](const BatchResult &result)
+			   {
+				   const auto &job = (*jobs)[result.job_index];
+				   total_frames += result.frames;
+				   if (result.ok)
+				   {
+					   std::printf("%zu %s ok frames=%u instructions=%llu hash=%016llx time=%.3fs\n", result.job_index, job.rom_path.c_str(),
+								   result.frames, static_cast<unsigned long long>(result.instructions),
+								   static_cast<unsigned long long>(result.state_hash), result.seconds);
+				   }
+				   else
+				   {
+					   ++failed;
+					   std::printf("%zu %s failed after %u frames: %s\n", result.job_index, job.rom_path.c_str(), result.frames, result.error.c_str());
+				   }
+				   std::fflush(stdout); });
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::printf("jobs: %zu (%u failed)\n", jobs->size(), failed);
+	std::printf("frames: %llu\n", static_cast<unsigned long long>(total_frames));
+	std::printf("wall time: %.3fs\n", elapsed.count());
+	std::printf("fps: %.1f\n", elapsed.count() > 0 ? total_frames / elapsed.count() : 0.0);
+	return failed ? 2 : 0;
+}
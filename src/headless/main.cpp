@@ -0,0 +1,429 @@
+#include <nes/core.hpp>
+#include <nes/cartridge.hpp>
+#include <nes/constants.hpp>
+#include <nes/movie.hpp>
+#include <nes/state_hash.hpp>
+#include <nes/bus_trace.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using namespace NESterpiece;
+
+	struct Options
+	{
+		std::string rom_path;
+		// defaults to the length of the movie, or 600 without one
+		std::optional<uint32_t> frames;
+		std::string movie_path;
+		// stop early once ram[address] == value, checked after every frame
+		std::optional<std::pair<uint16_t, uint8_t>> until_ram;
+		// stop in the middle of a frame, the cycle budget is for the whole run
+		StopConditions until;
+		std::optional<uint64_t> cycles;
+		std::string frame_dir;
+		std::string ram_path;
+		std::string trace_path;
+		bool print_hash = false;
+		bool skip_idle_loops = true;
+	};
+
+	void print_usage()
+	{
+		std::printf("usage: NESterpiece-Headless <rom> [options]\n"
+					"  --frames <n>            run at most n frames (default 600 or the movie's length)\n"
+					"  --movie <file>          start where the movie starts and play back its input\n"
+					"  --cycles <n>            run at most n cpu cycles\n"
+					"  --until-ram <addr>=<v>  stop once the byte at hex addr equals hex v\n"
+					"  --until-pc <addr>       stop before the instruction at hex addr\n"
+					"  --until-write <a>[-<b>] stop after the cpu writes to hex address a, or a to b\n"
+					"  --until-dot <line>,<d>  stop once the ppu reaches scanline line (0-261), dot d (0-340)\n"
+					"  --dump-frames <dir>     write every frame to dir as a ppm image\n"
+					"  --dump-ram <file>       write the 2KB of internal ram to file when done\n"
+					"  --trace <file>          write every cpu bus access to file as text\n"
+					"  --hash                  print a hash of the final machine state\n"
+					"  --no-idle-skip          always execute idle loops instruction by instruction\n");
+	}
+
+	std::optional<Options> parse_options(int argc, char **argv)
+	{
+		if (argc < 2)
+			return std::nullopt;
+
+		Options options;
+		options.rom_path = argv[1];
+		for (int i = 2; i < argc; ++i)
+		{
+			const std::string_view arg = argv[i];
+			const bool has_value = i + 1 < argc;
+			try
+			{
+				if (arg == "--frames" && has_value)
+				{
+					options.frames = std::stoul(argv[++i]);
+				}
+				else if (arg == "--movie" && has_value)
+				{
+					options.movie_path = argv[++i];
+				}
+				else if (arg == "--cycles" && has_value)
+				{
+					options.cycles = std::stoull(argv[++i]);
+				}
+				else if (arg == "--until-pc" && has_value)
+				{
+					options.until.pc = static_cast<uint16_t>(std::stoul(argv[++i], nullptr, 16));
+				}
+				else if (arg == "--until-write" && has_value)
+				{
+					const std::string value = argv[++i];
+					const auto separator = value.find('-');
+					const auto first = static_cast<uint16_t>(std::stoul(value.substr(0, separator), nullptr, 16));
+					const auto last = separator == std::string::npos ? first : static_cast<uint16_t>(std::stoul(value.substr(separator + 1), nullptr, 16));
+					options.until.write_range = std::make_pair(first, last);
+				}
+				else if (arg == "--until-dot" && has_value)
+				{
+					const std::string value = argv[++i];
+					const auto separator = value.find(',');
+					if (separator == std::string::npos)
+						return std::nullopt;
+					const auto scanline = std::stoul(value.substr(0, separator));
+					const auto dot = std::stoul(value.substr(separator + 1));
+					if (scanline > 261 || dot > 340)
+						return std::nullopt;
+					options.until.scanline_dot = std::make_pair(static_cast<uint16_t>(scanline), static_cast<uint16_t>(dot));
+				}
+				else if (arg == "--until-ram" && has_value)
+				{
+					const std::string value = argv[++i];
+					const auto separator = value.find('=');
+					if (separator == std::string::npos)
+						return std::nullopt;
+					options.until_ram = std::make_pair(static_cast<uint16_t>(std::stoul(value.substr(0, separator), nullptr, 16)),
+													   static_cast<uint8_t>(std::stoul(value.substr(separator + 1), nullptr, 16)));
+				}
+				else if (arg == "--dump-frames" && has_value)
+				{
+					options.frame_dir = argv[++i];
+				}
+				else if (arg == "--dump-ram" && has_value)
+				{
+					options.ram_path = argv[++i];
+				}
+				else if (arg == "--trace" && has_value)
+				{
+					options.trace_path = argv[++i];
+				}
+				else if (arg == "--hash")
+				{
+					options.print_hash = true;
+				}
+				else if (arg == "--no-idle-skip")
+				{
+					options.skip_idle_loops = false;
+				}
+				else
+				{
+					return std::nullopt;
+				}
+			}
+			catch (const std::exception &)
+			{
+				return std::nullopt;
+			}
+		}
+
+		return options;
+	}
+
+	const char *stop_reason_name(StopReason reason)
+	{
+		switch (reason)
+		{
+		case StopReason::CycleBudget:
+			return "cycle budget";
+		case StopReason::PC:
+			return "pc";
+		case StopReason::MemoryWrite:
+			return "memory write";
+		case StopReason::ScanlineDot:
+			return "scanline and dot";
+		case StopReason::Frames:
+			return "frames";
+		default:
+			return "nothing";
+		}
+	}
+
+	// drains the core's bus trace into a text file on its own thread, one
+	// "R|W address value" line per access
+	class TraceWriter
+	{
+		BusTrace trace;
+		std::FILE *file = nullptr;
+		std::atomic<bool> running = true;
+		std::thread worker;
+		uint64_t written = 0;
+
+		void drain()
+		{
+			written += trace.drain([this](const BusActivity &activity) {
+				std::fprintf(file, "%c %04X %02X\n", activity.type == BusActivityType::Write ? 'W' : 'R', activity.address, activity.value);
+			});
+		}
+
+	public:
+		explicit TraceWriter(const std::string &path)
+		{
+			file = std::fopen(path.c_str(), "w");
+			if (!file)
+				return;
+
+			worker = std::thread([this]() {
+				while (running.load(std::memory_order_acquire))
+				{
+					drain();
+					std::this_thread::yield();
+				}
+				drain();
+			});
+		}
+
+		~TraceWriter()
+		{
+			finish();
+		}
+
+		bool is_open() const
+		{
+			return file != nullptr;
+		}
+
+		BusTrace *ring()
+		{
+			return &trace;
+		}
+
+		// a frame never makes more accesses than the ring holds, waiting for it to empty
+		// between frames keeps the file complete
+		void wait_until_drained() const
+		{
+			while (running.load(std::memory_order_relaxed) && trace.size() != 0)
+				std::this_thread::yield();
+		}
+
+		// joins the writer, after that the counts are final
+		void finish()
+		{
+			running.store(false, std::memory_order_release);
+			if (worker.joinable())
+				worker.join();
+			if (file)
+			{
+				std::fclose(file);
+				file = nullptr;
+			}
+		}
+
+		uint64_t written_count() const
+		{
+			return written;
+		}
+
+		uint64_t dropped_count() const
+		{
+			return trace.dropped_count();
+		}
+	};
+
+	bool write_frame(const std::filesystem::path &path, const Frame &frame)
+	{
+		std::vector<uint32_t> pixels(SCREEN_WIDTH * SCREEN_HEIGHT);
+		frame.convert(pixels.data(), SCREEN_WIDTH);
+
+		std::vector<uint8_t> rgb;
+		rgb.reserve(pixels.size() * 3);
+		for (const uint32_t pixel : pixels)
+		{
+			rgb.push_back(pixel >> 24);
+			rgb.push_back((pixel >> 16) & 0xFF);
+			rgb.push_back((pixel >> 8) & 0xFF);
+		}
+
+		std::ofstream file(path, std::ios::binary);
+		file << "P6\n"
+			 << SCREEN_WIDTH << " " << SCREEN_HEIGHT << "\n255\n";
+		file.write(reinterpret_cast<const char *>(rgb.data()), rgb.size());
+		return file.good();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	using namespace NESterpiece;
+
+	const auto options = parse_options(argc, argv);
+	if (!options)
+	{
+		print_usage();
+		return 1;
+	}
+
+	auto cart = Cartridge::from_file(options->rom_path);
+	if (!cart)
+	{
+		std::printf("Unable to load rom.\n");
+		return 1;
+	}
+
+	std::optional<Movie> movie;
+	if (!options->movie_path.empty())
+	{
+		movie = Movie::load(options->movie_path);
+		if (!movie)
+		{
+			std::printf("Unable to load movie.\n");
+			return 1;
+		}
+	}
+
+	if (!options->frame_dir.empty())
+		std::filesystem::create_directories(options->frame_dir);
+
+	// declared before the core so it outlives the pointer the bus keeps
+	std::unique_ptr<TraceWriter> trace;
+	if (!options->trace_path.empty())
+	{
+		trace = std::make_unique<TraceWriter>(options->trace_path);
+		if (!trace->is_open())
+		{
+			std::printf("Unable to open trace file.\n");
+			return 1;
+		}
+	}
+
+	auto core = std::make_unique<Core>();
+	core->skip_idle_loops = options->skip_idle_loops;
+	core->reset(std::move(cart));
+	if (trace)
+		core->bus.trace = trace->ring();
+	if (movie && !movie->start_playback(*core))
+	{
+		std::printf("The movie was recorded with a different rom.\n");
+		return 1;
+	}
+
+	const uint32_t frames = options->frames.value_or(movie ? static_cast<uint32_t>(movie->buttons.size()) : 600);
+
+	uint32_t frames_run = 0;
+	uint64_t cycles_run = 0;
+	bool condition_met = false;
+	std::optional<RunResult> stopped_early;
+	std::chrono::duration<double> emulation_time{0};
+	try
+	{
+		while (frames_run < frames && !condition_met)
+		{
+			if (movie)
+				core->bus.pad.set_buttons(movie->frame_buttons(frames_run));
+
+			StopConditions until = options->until;
+			until.frames = 1;
+			if (options->cycles)
+			{
+				if (cycles_run >= *options->cycles)
+					break;
+				until.cycles = *options->cycles - cycles_run;
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			const RunResult run = core->run_until(until);
+			emulation_time += std::chrono::steady_clock::now() - start;
+			cycles_run += run.cycles;
+			if (run.reason != StopReason::Frames)
+			{
+				stopped_early = run;
+				condition_met = run.reason != StopReason::CycleBudget && run.reason != StopReason::None;
+				break;
+			}
+			++frames_run;
+			if (trace)
+				trace->wait_until_drained();
+
+			if (!options->frame_dir.empty())
+			{
+				char name[32];
+				std::snprintf(name, sizeof(name), "frame_%06u.ppm", frames_run);
+				if (!write_frame(std::filesystem::path(options->frame_dir) / name, core->ppu.frame))
+				{
+					std::printf("Unable to write frame %u.\n", frames_run);
+					return 1;
+				}
+			}
+
+			if (options->until_ram)
+			{
+				const auto [address, value] = *options->until_ram;
+				condition_met = core->bus.internal_ram[address & 0x7FF] == value;
+			}
+		}
+	}
+	catch (const char *error)
+	{
+		std::printf("Emulation stopped at pc %04X after %u frames: %s\n", core->cpu.registers.pc, frames_run, error);
+		return 1;
+	}
+
+	if (!options->ram_path.empty())
+	{
+		std::ofstream file(options->ram_path, std::ios::binary);
+		file.write(reinterpret_cast<const char *>(core->bus.internal_ram.data()), core->bus.internal_ram.size());
+		if (!file.good())
+		{
+			std::printf("Unable to write ram.\n");
+			return 1;
+		}
+	}
+
+	if (trace)
+	{
+		trace->finish();
+		std::printf("trace: %llu accesses written, %llu dropped\n", static_cast<unsigned long long>(trace->written_count()),
+					static_cast<unsigned long long>(trace->dropped_count()));
+	}
+
+	const double seconds = emulation_time.count();
+	if (stopped_early)
+	{
+		std::printf("stopped by: %s at pc %04X, scanline %u dot %u\n", stop_reason_name(stopped_early->reason), core->cpu.registers.pc,
+					core->ppu.scanline_num, core->ppu.cycles);
+		if (stopped_early->reason == StopReason::MemoryWrite)
+			std::printf("write: %02X to %04X\n", stopped_early->write_value, stopped_early->write_address);
+	}
+	std::printf("frames: %u\n", frames_run);
+	std::printf("cycles: %llu\n", static_cast<unsigned long long>(cycles_run));
+	std::printf("instructions: %llu\n", static_cast<unsigned long long>(core->instruction_count));
+	std::printf("wall time: %.3fs\n", seconds);
+	std::printf("fps: %.1f\n", seconds > 0 ? frames_run / seconds : 0.0);
+	std::printf("instructions/s: %.0f\n", seconds > 0 ? core->instruction_count / seconds : 0.0);
+	if (options->print_hash)
+		std::printf("state hash: %016llx\n", static_cast<unsigned long long>(hash_state(*core)));
+
+	// a stop condition that never triggered is a failure for scripts
+	const bool has_condition = options->until_ram || options->until.pc || options->until.write_range || options->until.scanline_dot;
+	if (has_condition && !condition_met)
+		return 2;
+
+	return 0;
+}
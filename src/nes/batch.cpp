@@ -0,0 +1,166 @@
+#include "batch.hpp"
+#include "core.hpp"
+#include "state_hash.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace NESterpiece
+{
+	std::optional<std::vector<InputEvent>> load_input_script(const std::string &path)
+	{
+		std::ifstream file(path);
+		if (!file)
+			return std::nullopt;
+
+		std::vector<InputEvent> events;
+		std::string line;
+		while (std::getline(file, line))
+		{
+			line = line.substr(0, line.find('#'));
+			std::istringstream stream(line);
+			uint32_t frame = 0, buttons = 0;
+			if (!(stream >> frame))
+			{
+				if (line.find_first_not_of(" \t\r") != std::string::npos)
+					return std::nullopt;
+				continue;
+			}
+
+			if (!(stream >> std::hex >> buttons) || buttons > 0xFF)
+				return std::nullopt;
+			if (!events.empty() && events.back().frame > frame)
+				return std::nullopt;
+
+			events.push_back({frame, static_cast<uint8_t>(buttons)});
+		}
+
+		return events;
+	}
+
+	std::optional<size_t> BatchRunner::WorkQueue::pop_front()
+	{
+		std::lock_guard lock(mutex);
+		if (jobs.empty())
+			return std::nullopt;
+
+		const size_t job = jobs.front();
+		jobs.pop_front();
+		return job;
+	}
+
+	std::optional<size_t> BatchRunner::WorkQueue::pop_back()
+	{
+		std::lock_guard lock(mutex);
+		if (jobs.empty())
+			return std::nullopt;
+
+		const size_t job = jobs.back();
+		jobs.pop_back();
+		return job;
+	}
+
+	BatchRunner::BatchRunner(uint32_t thread_count)
+		: thread_count(thread_count ? thread_count : std::max(1u, std::thread::hardware_concurrency()))
+	{
+	}
+
+	void BatchRunner::run(const std::vector<BatchJob> &jobs, const std::function<void(const BatchResult &)> &on_result)
+	{
+		if (jobs.empty())
+			return;
+
+		// every rom is read and decoded once, all cartridges made from it share the image
+		std::unordered_map<std::string, std::shared_ptr<const RomImage>> roms;
+		for (const auto &job : jobs)
+		{
+			if (!roms.contains(job.rom_path))
+				roms.emplace(job.rom_path, RomImage::from_file(job.rom_path));
+		}
+
+		const uint32_t workers = std::min<size_t>(thread_count, jobs.size());
+		std::vector<WorkQueue> queues(workers);
+		for (size_t i = 0; i < jobs.size(); ++i)
+			queues[i % workers].jobs.push_back(i);
+
+		std::mutex result_mutex;
+		auto work = [&](uint32_t id)
+		{
+			while (true)
+			{
+				std::optional<size_t> job = queues[id].pop_front();
+				for (uint32_t offset = 1; !job && offset < workers; ++offset)
+					job = queues[(id + offset) % workers].pop_back();
+
+				// nothing is ever queued after the start, so empty everywhere means done
+				if (!job)
+					return;
+
+				BatchResult result = run_job(jobs[*job], roms.at(jobs[*job].rom_path));
+				result.job_index = *job;
+
+				std::lock_guard lock(result_mutex);
+				on_result(result);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (uint32_t id = 1; id < workers; ++id)
+			threads.emplace_back(work, id);
+
+		work(0);
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	BatchResult BatchRunner::run_job(const BatchJob &job, std::shared_ptr<const RomImage> rom)
+	{
+		BatchResult result;
+		auto cart = Cartridge::from_image(std::move(rom));
+		if (!cart)
+		{
+			result.error = "unable to load rom";
+			return result;
+		}
+
+		auto core = std::make_unique<Core>();
+		core->reset(std::move(cart));
+		if (job.movie && !job.movie->start_playback(*core))
+		{
+			result.error = "movie was recorded with a different rom";
+			return result;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		try
+		{
+			size_t next_input = 0;
+			uint8_t buttons = 0;
+			for (; result.frames < job.frames; ++result.frames)
+			{
+				if (job.movie)
+					buttons = job.movie->frame_buttons(result.frames);
+				while (next_input < job.inputs.size() && job.inputs[next_input].frame <= result.frames)
+					buttons = job.inputs[next_input++].buttons;
+
+				core->bus.pad.set_buttons(buttons);
+				core->tick_until_vblank();
+			}
+			result.ok = true;
+		}
+		catch (const char *error)
+		{
+			result.error = error;
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		result.seconds = elapsed.count();
+		result.instructions = core->instruction_count;
+		result.state_hash = hash_state(*core);
+		return result;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "cartridge.hpp"
+#include "movie.hpp"
+#include <cinttypes>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace NESterpiece
+{
+	// from `frame` on the controller reports `buttons`, a StdControllerButton mask
+	struct InputEvent
+	{
+		uint32_t frame = 0;
+		uint8_t buttons = 0;
+	};
+
+	// one line per event, "<frame> <hex buttons>", sorted by frame. # starts a comment
+	std::optional<std::vector<InputEvent>> load_input_script(const std::string &path);
+
+	struct BatchJob
+	{
+		std::string rom_path;
+		std::vector<InputEvent> inputs;
+		// when set the job starts where the movie does and takes its input from it
+		std::shared_ptr<const Movie> movie;
+		uint32_t frames = 600;
+	};
+
+	struct BatchResult
+	{
+		size_t job_index = 0;
+		bool ok = false;
+		std::string error;
+		uint32_t frames = 0;
+		uint64_t instructions = 0;
+		uint64_t state_hash = 0;
+		double seconds = 0;
+	};
+
+	// runs independent cores on a pool of threads. every worker starts with its own share
+	// of the jobs and steals from the others once it runs out, jobs using the same rom
+	// share one RomImage
+	class BatchRunner
+	{
+		// a worker takes from the front of its own queue, thieves take from the back
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<size_t> jobs;
+
+			std::optional<size_t> pop_front();
+			std::optional<size_t> pop_back();
+		};
+
+		uint32_t thread_count;
+
+	public:
+		explicit BatchRunner(uint32_t thread_count = 0);
+
+		// blocks until every job finished. on_result is called once per job as it
+		// finishes, from the worker threads but never concurrently
+		void run(const std::vector<BatchJob> &jobs, const std::function<void(const BatchResult &)> &on_result);
+
+		static BatchResult run_job(const BatchJob &job, std::shared_ptr<const RomImage> rom);
+	};
+}
@@ -1,47 +1,87 @@
 #include "bus.hpp"
+#include "bus_trace.hpp"
 #include "cpu.hpp"
 #include "cartridge.hpp"
 #include "ppu.hpp"
 #include "oam.hpp"
 #include "core.hpp"
 #include "constants.hpp"
+#include "save_state.hpp"
 
 namespace NESterpiece
 {
+	void Bus::load_cartridge(std::shared_ptr<Cartridge> cartridge)
+	{
+		cart = std::move(cartridge);
+		memory_map = MemoryMap{};
+		memory_map.map(0, 0x1FFF, internal_ram.data(), internal_ram.size(), true);
+		cart->map_prg(memory_map);
+		ppu.memory_map = VideoMemoryMap{};
+		cart->map_chr(ppu.memory_map);
+	}
+
+	void Bus::serialize(StateArchive &archive)
+	{
+		archive(internal_ram);
+		pad.serialize(archive);
+		if (cart)
+		{
+			cart->serialize(archive);
+			// banks may have changed
+			if (archive.loading())
+			{
+				cart->map_prg(memory_map);
+				cart->map_chr(ppu.memory_map);
+			}
+		}
+	}
 
 	uint8_t Bus::read(uint16_t address)
 	{
 		core.tick_components(true);
-		activity = {
-			.value = 0,
-			.address = address,
-			.type = BusActivityType::Read,
-		};
+		const uint8_t value = read_no_tick(address);
 
-		return read_no_tick(address);
+		if (trace) [[unlikely]]
+		{
+			trace->push({
+				.value = value,
+				.address = address,
+				.type = BusActivityType::Read,
+			});
+		}
+
+		return value;
 	}
 
 	void Bus::write(uint16_t address, uint8_t value)
 	{
 		core.tick_components(false);
-		activity = {
-			.value = value,
-			.address = address,
-			.type = BusActivityType::Write,
-		};
+
+		if (trace) [[unlikely]]
+		{
+			trace->push({
+				.value = value,
+				.address = address,
+				.type = BusActivityType::Write,
+			});
+		}
+
+		if (write_watch.active) [[unlikely]]
+			write_watch.check(address, value);
 
 		write_no_tick(address, value);
 	}
 
 	uint8_t Bus::read_no_tick(uint16_t address)
 	{
-		if (within_range<uint16_t>(address, 0, 0x7FF) || within_range<uint16_t>(address, 0x800, 0xFFF) || within_range<uint16_t>(address, 0x1000, 0x17FF) || within_range<uint16_t>(address, 0x1800, 0x1FFF))
+		if (const uint8_t *page = memory_map.read_pages[address >> PAGE_SHIFT])
 		{
-			return activity.value = internal_ram[address & 0x7FF];
+			return page[address & (PAGE_SIZE - 1)];
 		}
 		else if (within_range<uint16_t>(address, 0x2000, 0x3FFF))
 		{
-			return activity.value = ppu.cpu_read(address);
+			core.sync_ppu();
+			return ppu.cpu_read(address);
 		}
 		else if (within_range<uint16_t>(address, 0x4000, 0x4017))
 		{
@@ -55,24 +95,20 @@ namespace NESterpiece
 		}
 		else if (within_range<uint16_t>(address, 0x4020, 0xFFFF))
 		{
-			uint16_t base = address;
-			return activity.value = cart->read(address);
+			return cart->read(address);
 		}
 
 		return 0;
 	}
 	void Bus::write_no_tick(uint16_t address, uint8_t value)
 	{
-
-		if (within_range<uint16_t>(address, 0, 0x7FF) ||
-			within_range<uint16_t>(address, 0x800, 0xFFF) ||
-			within_range<uint16_t>(address, 0x1000, 0x17FF) ||
-			within_range<uint16_t>(address, 0x1800, 0x1FFF))
+		if (uint8_t *page = memory_map.write_pages[address >> PAGE_SHIFT])
 		{
-			internal_ram[address & 0x7FF] = value;
+			page[address & (PAGE_SIZE - 1)] = value;
 		}
 		else if (within_range<uint16_t>(address, 0x2000, 0x3FFF))
 		{
+			core.sync_ppu();
 			ppu.cpu_write(address, value);
 		}
 		else if (within_range<uint16_t>(address, 0x4000, 0x4017))
@@ -81,6 +117,7 @@ namespace NESterpiece
 			{
 			case 0x14:
 				oam_dma.start(value);
+				core.schedule_oam_dma();
 				break;
 			case 0x16:
 				pad.write(value);
@@ -89,7 +126,16 @@ namespace NESterpiece
 		}
 		else if (within_range<uint16_t>(address, 0x4020, 0xFFFF))
 		{
-			cart->write(address, value);
+			// mapper registers sit at $8000 and up. a bank or mirroring change is visible to
+			// the ppu at once through read_unmapped, so it has to catch up before the write.
+			// ram writes change nothing it can see
+			if (address >= 0x8000)
+				core.sync_ppu();
+			if (cart->write(address, value))
+			{
+				cart->map_prg(memory_map);
+				cart->map_chr(ppu.memory_map);
+			}
 		}
 	}
 }
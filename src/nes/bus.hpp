@@ -1,5 +1,7 @@
 #pragma once
 #include "pad.hpp"
+#include "bus_activity.hpp"
+#include "memory_map.hpp"
 #include <cinttypes>
 #include <array>
 #include <memory>
@@ -10,17 +12,26 @@ namespace NESterpiece
 	class PPU;
 	class OAMDMA;
 	class Core;
+	class BusTrace;
+	class StateArchive;
 
-	enum BusActivityType
+	// the first cpu write into [first, last] while active
+	struct WriteWatch
 	{
-		Read = 0,
-		Write = 1
-	};
-	struct BusActivity
-	{
-		uint8_t value = 0;
+		bool active = false, hit = false;
+		uint16_t first = 0, last = 0;
 		uint16_t address = 0;
-		BusActivityType type = BusActivityType::Read;
+		uint8_t value = 0;
+
+		void check(uint16_t write_address, uint8_t write_value)
+		{
+			if (!hit && write_address >= first && write_address <= last)
+			{
+				hit = true;
+				address = write_address;
+				value = write_value;
+			}
+		}
 	};
 
 	class Bus
@@ -30,11 +41,16 @@ namespace NESterpiece
 		Core &core;
 
 	public:
-		BusActivity activity;
+		// accesses are only recorded while a trace is attached, the owner keeps it alive
+		BusTrace *trace = nullptr;
+		WriteWatch write_watch;
 		StdController pad;
 		Bus(PPU &ppu, OAMDMA &oam_dma, Core &core) : ppu(ppu), oam_dma(oam_dma), core(core) {}
 		std::array<uint8_t, 0x800> internal_ram{};
 		std::shared_ptr<Cartridge> cart{};
+		MemoryMap memory_map;
+		void load_cartridge(std::shared_ptr<Cartridge> cartridge);
+		void serialize(StateArchive &archive);
 		uint8_t read(uint16_t address);
 		void write(uint16_t address, uint8_t value);
 
@@ -0,0 +1,17 @@
+#pragma once
+#include <cinttypes>
+
+namespace NESterpiece
+{
+	enum BusActivityType
+	{
+		Read = 0,
+		Write = 1
+	};
+	struct BusActivity
+	{
+		uint8_t value = 0;
+		uint16_t address = 0;
+		BusActivityType type = BusActivityType::Read;
+	};
+}
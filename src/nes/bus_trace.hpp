@@ -0,0 +1,61 @@
+#pragma once
+#include "bus_activity.hpp"
+#include <cinttypes>
+#include <array>
+#include <atomic>
+
+namespace NESterpiece
+{
+	// fixed size single producer, single consumer ring of bus accesses. the emulation
+	// thread pushes, a debugger or file writer drains from any one other thread.
+	// when the ring is full new accesses are dropped and counted instead of blocking
+	class BusTrace
+	{
+	public:
+		static constexpr uint32_t CAPACITY = 1 << 16;
+
+	private:
+		std::array<BusActivity, CAPACITY> entries{};
+		alignas(64) std::atomic<uint64_t> write_index = 0;
+		alignas(64) std::atomic<uint64_t> read_index = 0;
+		std::atomic<uint64_t> dropped = 0;
+
+	public:
+		void push(const BusActivity &activity)
+		{
+			const uint64_t head = write_index.load(std::memory_order_relaxed);
+			if (head - read_index.load(std::memory_order_acquire) == CAPACITY)
+			{
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			entries[head % CAPACITY] = activity;
+			write_index.store(head + 1, std::memory_order_release);
+		}
+
+		// calls f for every access recorded since the last drain, oldest first
+		template <class F>
+		uint64_t drain(F &&f)
+		{
+			const uint64_t tail = read_index.load(std::memory_order_relaxed);
+			const uint64_t head = write_index.load(std::memory_order_acquire);
+			for (uint64_t i = tail; i < head; ++i)
+				f(entries[i % CAPACITY]);
+
+			read_index.store(head, std::memory_order_release);
+			return head - tail;
+		}
+
+		// accesses waiting to be drained
+		uint64_t size() const
+		{
+			return write_index.load(std::memory_order_acquire) - read_index.load(std::memory_order_acquire);
+		}
+
+		uint64_t dropped_count() const
+		{
+			return dropped.load(std::memory_order_relaxed);
+		}
+	};
+}
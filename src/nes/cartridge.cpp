@@ -1,13 +1,15 @@
 #include "cartridge.hpp"
 #include "constants.hpp"
+#include "save_state.hpp"
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <vector>
 namespace NESterpiece
 {
-	Cartridge::Cartridge(INESHeader &&header) : header(std::move(header)) {}
+	Cartridge::Cartridge(std::shared_ptr<const RomImage> rom) : header(rom->header), rom(std::move(rom)) {}
 
-	std::shared_ptr<Cartridge> Cartridge::from_file(std::string path)
+	std::shared_ptr<const RomImage> RomImage::from_file(std::string path)
 	{
 		constexpr std::array<char, 4> TARGET_MAGIC{
 			'N',
@@ -24,7 +26,8 @@ namespace NESterpiece
 		if (magic != TARGET_MAGIC)
 			std::cout << "file is not an iNES rom\n";
 
-		INESHeader header;
+		auto image = std::make_shared<RomImage>();
+		INESHeader &header = image->header;
 		rom_file.read(reinterpret_cast<char *>(&header.prg_rom_low_byte), 1);
 		rom_file.read(reinterpret_cast<char *>(&header.chr_rom_low_byte), 1);
 		rom_file.read(reinterpret_cast<char *>(&header.flags_6.data), 1);
@@ -38,22 +41,48 @@ namespace NESterpiece
 		rom_file.read(reinterpret_cast<char *>(&header.num_misc_roms), 1);
 		rom_file.read(reinterpret_cast<char *>(&header.default_expansion_device), 1);
 
-		auto mapper = header.combined_mapper_id();
-		switch (mapper)
+		image->prg_rom.resize(16384 * header.prg_rom_low_byte);
+		image->chr_rom.resize(8192 * header.chr_rom_low_byte);
+		rom_file.read(reinterpret_cast<char *>(image->prg_rom.data()), image->prg_rom.size());
+		rom_file.read(reinterpret_cast<char *>(image->chr_rom.data()), image->chr_rom.size());
+		image->chr_cache.build(image->chr_rom.data(), image->chr_rom.size());
+
+		return image;
+	}
+
+	std::shared_ptr<Cartridge> Cartridge::from_image(std::shared_ptr<const RomImage> rom)
+	{
+		switch (rom->header.combined_mapper_id())
 		{
 		case 0:
-			return std::make_shared<NROM>(std::move(header), std::move(rom_file));
+			// nrom boards have at most 32 KiB of prg and 8 KiB of chr
+			if (rom->prg_rom.empty() || rom->prg_rom.size() > 0x8000 || rom->chr_rom.size() > 0x2000)
+				return nullptr;
+			return std::make_shared<NROM>(std::move(rom));
 		}
 
 		return nullptr;
 	}
 
-	NROM::NROM(INESHeader &&header, std::ifstream rom_file)
-		: Cartridge(std::move(header))
+	std::shared_ptr<Cartridge> Cartridge::from_file(std::string path)
 	{
-		rom_file.read(reinterpret_cast<char *>(prg_rom.data()), 16384 * header.prg_rom_low_byte);
-		rom_file.read(reinterpret_cast<char *>(chr_rom.data()), 8192 * header.chr_rom_low_byte);
-		rom_file.close();
+		return from_image(RomImage::from_file(std::move(path)));
+	}
+
+	NROM::NROM(std::shared_ptr<const RomImage> rom)
+		: Cartridge(std::move(rom))
+	{
+		if (header.chr_rom_low_byte != 0)
+		{
+			chr = this->rom->chr_rom.data();
+			chr_cache = &this->rom->chr_cache;
+		}
+		else
+		{
+			chr_ram_cache.build(chr_ram.data(), chr_ram.size());
+			chr = chr_ram.data();
+			chr_cache = &chr_ram_cache;
+		}
 	}
 
 	uint8_t NROM::read(uint16_t address)
@@ -64,28 +93,83 @@ namespace NESterpiece
 		}
 		else if (within_range<uint16_t>(address, 0x8000, 0xBFFF))
 		{
-			return prg_rom[address - 0x8000];
+			return rom->prg_rom[address - 0x8000];
 		}
 		else if (within_range<uint16_t>(address, 0xC000, 0xFFFF))
 		{
 			const uint16_t offset = header.prg_rom_low_byte == 2 ? 0x8000 : 0xC000;
-			auto ret = prg_rom[address - offset];
+			auto ret = rom->prg_rom[address - offset];
 			return ret;
 		}
 
 		return 0;
 	}
 
-	void NROM::write(uint16_t address, uint8_t value)
+	bool NROM::write(uint16_t address, uint8_t value)
 	{
 		if (within_range<uint16_t>(address, 0x6000, 0x7FFF))
 			prg_ram[address - 0x6000] = value;
+
+		// no registers, nothing ever switches
+		return false;
+	}
+
+	void NROM::map_prg(MemoryMap &map)
+	{
+		// nothing to switch, so only the first call does any work
+		if (map.read_pages[0x8000 >> PAGE_SHIFT])
+			return;
+
+		map.map(0x6000, 0x7FFF, prg_ram.data(), prg_ram.size(), true);
+		map.map(0x8000, 0xFFFF, rom->prg_rom.data(), rom->prg_rom.size());
+	}
+
+	void NROM::map_chr(VideoMemoryMap &map)
+	{
+		if (map.read_pages[0])
+			return;
+
+		// chr writes always go through write_chr so the cache stays current
+		map.map(0x0000, 0x1FFF, chr, 0x2000);
+		for (uint32_t page = 0; page < map.pattern_rows.size(); ++page)
+			map.pattern_rows[page] = chr_cache->page(page * PAGE_SIZE);
+
+		for (uint16_t address = 0x2000; address < 0x4000; address += PAGE_SIZE)
+		{
+			const uint16_t table = (address >> PAGE_SHIFT) & 3;
+			const uint16_t offset = header.flags_6.mirror() ? (table & 1) * PAGE_SIZE : (table >> 1) * PAGE_SIZE;
+			map.map(address, address + PAGE_SIZE - 1, nametables.data() + offset, PAGE_SIZE, true);
+		}
+	}
+
+	void NROM::serialize(StateArchive &archive)
+	{
+		archive(prg_ram, nametables);
+		if (header.chr_rom_low_byte != 0)
+			return;
+
+		if (!archive.loading())
+		{
+			archive(chr_ram);
+			return;
+		}
+
+		// only tiles that differ need decoding again, usually few or none
+		std::array<uint8_t, 8192> loaded{};
+		archive(loaded);
+		for (uint32_t tile = 0; tile < chr_ram.size() / 16; ++tile)
+		{
+			if (std::memcmp(&chr_ram[tile * 16], &loaded[tile * 16], 16) == 0)
+				continue;
+
+			std::memcpy(&chr_ram[tile * 16], &loaded[tile * 16], 16);
+			chr_ram_cache.update_tile(chr_ram.data(), tile);
+		}
 	}
 
 	uint8_t NROM::read_chr(uint16_t address)
 	{
-		uint16_t addr = address;
-		return chr_rom[addr];
+		return chr[address & 0x1FFF];
 	}
 
 	uint8_t NROM::read_chr(uint16_t pattern_table_half, uint16_t tile_id, uint16_t bit_plane, uint16_t fine_y)
@@ -101,7 +185,12 @@ namespace NESterpiece
 
 	void NROM::write_chr(uint16_t address, uint8_t value)
 	{
-		// not supported on NROM
+		// only boards without chr rom have ram there
+		if (header.chr_rom_low_byte != 0)
+			return;
+
+		chr_ram[address & 0x1FFF] = value;
+		chr_ram_cache.update_tile(chr_ram.data(), (address & 0x1FFF) >> 4);
 	}
 
 	uint8_t NROM::read_nametable(uint16_t address)
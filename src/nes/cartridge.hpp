@@ -4,10 +4,13 @@
 #include <bitset>
 #include <string>
 #include <memory>
-#include <fstream>
+#include <vector>
+#include "memory_map.hpp"
 
 namespace NESterpiece
 {
+	class StateArchive;
+
 	enum class ConsoleType
 	{
 		NES,
@@ -99,40 +102,73 @@ namespace NESterpiece
 		uint16_t combined_mapper_id() const { return flags_6.mapper_first_nibble() | (flags_7.mapper_second_nibble() << 4) | (m_info.mapper_third_nibble() << 8); }
 	};
 
+	// everything read from a rom file. it's never modified after loading, so one image
+	// can back any number of cartridges running in parallel
+	struct RomImage
+	{
+		INESHeader header;
+		std::vector<uint8_t> prg_rom;
+		std::vector<uint8_t> chr_rom;
+		ChrCache chr_cache;
+
+		static std::shared_ptr<const RomImage> from_file(std::string path);
+	};
+
 	class Cartridge
 	{
 	public:
 		INESHeader header;
-		Cartridge(INESHeader &&header);
+		std::shared_ptr<const RomImage> rom;
+		Cartridge(std::shared_ptr<const RomImage> rom);
 		virtual ~Cartridge() = default;
 
 		virtual uint8_t read(uint16_t address) = 0;
-		virtual void write(uint16_t address, uint8_t value) = 0;
+		// true when the write switched banks or mirroring, i.e. the maps have to be redone
+		virtual bool write(uint16_t address, uint8_t value) = 0;
 		virtual uint8_t read_chr(uint16_t address) = 0;
 		virtual uint8_t read_chr(uint16_t pattern_table_half, uint16_t tile_id, uint16_t bit_plane, uint16_t fine_y) = 0;
 		virtual void write_chr(uint16_t address, uint8_t value) = 0;
 		virtual uint8_t read_nametable(uint16_t address) = 0;
 		virtual void write_nametable(uint16_t address, uint8_t value) = 0;
 
+		// points the cpu pages of $4020-$FFFF that are backed by plain memory at the
+		// current banks, called on load and after every write that reports a change
+		virtual void map_prg(MemoryMap &map) = 0;
+
+		// same for the ppu's pattern tables and nametables at $0000-$3EFF
+		virtual void map_chr(VideoMemoryMap &map) = 0;
+
+		// ram and mapper registers, the rom image is never part of a state
+		virtual void serialize(StateArchive &archive) = 0;
+
+		// a fresh cartridge with its own ram around a shared rom image
+		static std::shared_ptr<Cartridge> from_image(std::shared_ptr<const RomImage> rom);
 		static std::shared_ptr<Cartridge> from_file(std::string path);
 	};
 
 	class NROM : public Cartridge
 	{
 	public:
-		std::array<uint8_t, 32768> prg_rom{};
 		std::array<uint8_t, 8192> prg_ram{};
-		std::array<uint8_t, 8192> chr_rom{};
 		std::array<uint8_t, 2048> nametables{};
+		// only used by boards without chr rom
+		std::array<uint8_t, 8192> chr_ram{};
+		ChrCache chr_ram_cache;
+		// the rom image's chr and its cache, or chr_ram and chr_ram_cache
+		const uint8_t *chr = nullptr;
+		const ChrCache *chr_cache = nullptr;
 
-		NROM(INESHeader &&header, std::ifstream stream);
+		NROM(std::shared_ptr<const RomImage> rom);
 
 		uint8_t read(uint16_t address) override;
-		void write(uint16_t address, uint8_t value) override;
+		bool write(uint16_t address, uint8_t value) override;
 		uint8_t read_chr(uint16_t address) override;
 		uint8_t read_chr(uint16_t pattern_table_half, uint16_t tile_id, uint16_t bit_plane, uint16_t fine_y) override;
 		void write_chr(uint16_t address, uint8_t value) override;
 		uint8_t read_nametable(uint16_t address) override;
 		void write_nametable(uint16_t address, uint8_t value) override;
+		void map_prg(MemoryMap &map) override;
+		void map_chr(VideoMemoryMap &map) override;
+		void serialize(StateArchive &archive) override;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include <cinttypes>
+#include <array>
+#include <vector>
+
+namespace NESterpiece
+{
+	// one row of a tile with its two bitplanes already combined, leftmost pixel first
+	using TileRow = std::array<uint8_t, 8>;
+
+	constexpr TileRow decode_tile_row(uint8_t low, uint8_t high)
+	{
+		TileRow row{};
+		for (uint8_t i = 0; i < 8; ++i)
+			row[i] = (((high >> (7 - i)) & 1) << 1) | ((low >> (7 - i)) & 1);
+
+		return row;
+	}
+
+	// pattern memory decoded into TileRows, 8 per tile. built once from rom and kept up to
+	// date one tile at a time when chr ram is written
+	class ChrCache
+	{
+	public:
+		std::vector<TileRow> rows{};
+
+		void build(const uint8_t *chr, uint32_t size)
+		{
+			rows.resize(size / 2);
+			for (uint32_t tile = 0; tile < size / 16; ++tile)
+				update_tile(chr, tile);
+		}
+
+		void update_tile(const uint8_t *chr, uint32_t tile)
+		{
+			for (uint32_t y = 0; y < 8; ++y)
+				rows[(tile * 8) + y] = decode_tile_row(chr[(tile * 16) + y], chr[(tile * 16) + 8 + y]);
+		}
+
+		// rows for the 1 KiB of pattern memory starting at offset
+		const TileRow *page(uint32_t offset) const
+		{
+			return rows.data() + (offset / 2);
+		}
+	};
+}
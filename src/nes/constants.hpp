@@ -82,6 +82,38 @@ namespace NESterpiece
 		0x000000FF,
 		0x000000FF};
 
+	// Palette2C02 for every combination of the emphasis bits (red, green, blue from bit 0),
+	// the channels that aren't emphasized are dimmed to about 82%
+	constexpr std::array<uint32_t, 64 * 8> build_emphasis_palette()
+	{
+		std::array<uint32_t, 64 * 8> table{};
+		for (uint32_t emphasis = 0; emphasis < 8; ++emphasis)
+		{
+			for (uint32_t index = 0; index < 64; ++index)
+			{
+				uint32_t color = Palette2C02[index];
+				if (emphasis != 0)
+				{
+					uint32_t dimmed = color & 0xFF;
+					for (uint32_t channel = 0; channel < 3; ++channel)
+					{
+						const uint32_t shift = 24 - (channel * 8);
+						uint32_t value = (color >> shift) & 0xFF;
+						if ((emphasis & (1 << channel)) == 0)
+							value = (value * 209) >> 8;
+						dimmed |= value << shift;
+					}
+					color = dimmed;
+				}
+				table[(emphasis * 64) + index] = color;
+			}
+		}
+
+		return table;
+	}
+
+	constexpr std::array<uint32_t, 64 * 8> EmphasisPalette2C02 = build_emphasis_palette();
+
 	template <class T>
 	constexpr bool within_range(T value, T start, T end)
 	{
@@ -1,5 +1,11 @@
 #include "core.hpp"
 #include "constants.hpp"
+#include "cartridge.hpp"
+#include "save_state.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
 
 namespace NESterpiece
 {
@@ -10,49 +16,434 @@ namespace NESterpiece
 
 	void Core::reset(std::shared_ptr<Cartridge> cart)
 	{
-		bus.cart = std::move(cart);
+		bus.load_cartridge(std::move(cart));
 		cpu.reset();
 		ppu.reset();
+		master_clock = ppu_clock = 0;
+		instruction_count = 0;
+		recent_pcs.fill(0);
+		scheduler.clear();
+		schedule_ppu_event(EventType::VBlank, 241, 1);
 	}
 
-	void Core::tick_components(bool read_cycle)
+	// 'NESS' followed by the version
+	static constexpr uint32_t SAVE_STATE_MAGIC = 0x5353454E;
+
+	size_t Core::state_size()
+	{
+		StateArchive archive(StateArchive::Mode::Measure);
+		serialize(archive);
+		return archive.size();
+	}
+
+	void Core::save_state(std::vector<uint8_t> &out)
+	{
+		out.resize(state_size());
+		StateArchive archive(out.data());
+		serialize(archive);
+	}
+
+	bool Core::load_state(const uint8_t *data, size_t size)
+	{
+		if (size != state_size())
+			return false;
+
+		uint32_t magic = 0, version = 0;
+		std::memcpy(&magic, data, sizeof(magic));
+		std::memcpy(&version, data + sizeof(magic), sizeof(version));
+		if (magic != SAVE_STATE_MAGIC || version != SAVE_STATE_VERSION)
+			return false;
+
+		StateArchive archive(data);
+		serialize(archive);
+		return true;
+	}
+
+	std::unique_ptr<Core> Core::clone()
+	{
+		auto copy = std::make_unique<Core>();
+		copy->skip_idle_loops = skip_idle_loops;
+		copy_into(*copy);
+		return copy;
+	}
+
+	void Core::copy_into(Core &target)
+	{
+		// the target needs its own cartridge ram around the same rom
+		if (!target.bus.cart || target.bus.cart == bus.cart || target.bus.cart->rom != bus.cart->rom)
+			target.reset(Cartridge::from_image(bus.cart->rom));
+
+		thread_local std::vector<uint8_t> state;
+		save_state(state);
+		target.load_state(state.data(), state.size());
+	}
+
+	void Core::serialize(StateArchive &archive)
+	{
+		uint32_t magic = SAVE_STATE_MAGIC, version = SAVE_STATE_VERSION;
+		archive(magic, version);
+		archive(master_clock, ppu_clock, recent_pcs, instruction_count);
+		scheduler.serialize(archive);
+		cpu.serialize(archive);
+		ppu.serialize(archive);
+		bus.serialize(archive);
+	}
+
+	void Core::sync_ppu()
 	{
-		if (read_cycle)
+		run_ppu_until(master_clock);
+	}
+
+	void Core::run_ppu_until(uint64_t timestamp)
+	{
+		while (ppu_clock < timestamp)
 		{
-			if (cpu.oam_dma.active)
+			// a whole visible line fits before anything can observe the ppu
+			if (ppu.cycles == 1 && ppu_clock + (255 * PPU_CLOCK_DIVIDER) < timestamp && ppu.can_render_line())
 			{
-				while (cpu.oam_dma.active)
-				{
-					for (uint32_t i = 0; i < 3; ++i)
-					{
-						ppu.step();
-					}
-					cpu.oam_dma.step(bus, ppu);
-				}
-			}
-			else
-			{
-				for (uint32_t i = 0; i < 3; ++i)
-				{
-					ppu.step();
-				}
+				ppu.render_line();
+				ppu_clock += 256 * PPU_CLOCK_DIVIDER;
+				continue;
 			}
+
+			ppu.step();
+			ppu_clock += PPU_CLOCK_DIVIDER;
 		}
-		else
+	}
+
+	void Core::schedule_ppu_event(EventType type, uint16_t scanline, uint16_t cycle)
+	{
+		scheduler.schedule(type, ppu_event_timestamp(scanline, cycle));
+	}
+
+	uint64_t Core::ppu_event_timestamp(uint16_t scanline, uint16_t cycle) const
+	{
+		constexpr uint32_t DOTS_PER_LINE = 341;
+		constexpr uint32_t DOTS_PER_FRAME = DOTS_PER_LINE * 262;
+
+		// the event's timestamp is the end of the target dot, counted from where the ppu is now
+		const uint32_t dot = (ppu.scanline_num * DOTS_PER_LINE) + ppu.cycles;
+		const uint32_t target = (scanline * DOTS_PER_LINE) + cycle;
+		const uint32_t dots_left = target >= dot ? target - dot : (DOTS_PER_FRAME - dot) + target;
+
+		return ppu_clock + (static_cast<uint64_t>(dots_left + 1) * PPU_CLOCK_DIVIDER);
+	}
+
+	void Core::schedule_oam_dma()
+	{
+		scheduler.schedule(EventType::OAMDMA, master_clock + CPU_CLOCK_DIVIDER);
+	}
+
+	void Core::run_events(bool read_cycle)
+	{
+		while (scheduler.next_timestamp() <= master_clock)
 		{
-			for (uint32_t i = 0; i < 3; ++i)
+			const ScheduledEvent event = scheduler.pop();
+			switch (event.type)
+			{
+			case EventType::VBlank:
+			{
+				run_ppu_until(event.timestamp - PPU_CLOCK_DIVIDER);
+				ppu.start_vblank();
+				schedule_ppu_event(EventType::PreRender, 261, 1);
+				break;
+			}
+			case EventType::PreRender:
+			{
+				run_ppu_until(event.timestamp - PPU_CLOCK_DIVIDER);
+				ppu.start_prerender();
+				schedule_ppu_event(EventType::OddFrameSkip, 261, 339);
+				break;
+			}
+			case EventType::OddFrameSkip:
 			{
-				ppu.step();
+				run_ppu_until(event.timestamp);
+				ppu.skip_odd_dot();
+				schedule_ppu_event(EventType::VBlank, 241, 1);
+				break;
+			}
+			case EventType::OAMDMA:
+			{
+				if (!cpu.oam_dma.active)
+					break;
+
+				// dma can only halt the cpu on a read cycle
+				if (read_cycle)
+					run_oam_dma();
+				else
+					schedule_oam_dma();
+				break;
+			}
+			case EventType::StopRun:
+			{
+				stop_requested = true;
+				break;
+			}
 			}
 		}
 	}
 
+	void Core::run_oam_dma()
+	{
+		while (cpu.oam_dma.active)
+		{
+			run_events(false);
+			sync_ppu();
+			cpu.oam_dma.step(bus, ppu);
+			master_clock += CPU_CLOCK_DIVIDER;
+		}
+
+		// the cpu's own read happens on the last dma cycle
+		master_clock -= CPU_CLOCK_DIVIDER;
+	}
+
 	void Core::tick_until_vblank()
 	{
 		do
 		{
+			// a trace should see every pass of the loop
+			if (skip_idle_loops && !bus.trace)
+				skip_idle_loop();
+
 			cpu.step(bus);
+			++instruction_count;
 
 		} while (!ppu.frame_ended());
+
+		sync_ppu();
+	}
+
+	RunResult Core::run_until(const StopConditions &conditions)
+	{
+		RunResult result;
+		if (!conditions.cycles && !conditions.pc && !conditions.write_range && !conditions.scanline_dot && !conditions.frames)
+			return result;
+		// a position the ppu never reaches would silently turn into a later one
+		if (conditions.scanline_dot && (conditions.scanline_dot->first > 261 || conditions.scanline_dot->second > 340))
+			return result;
+
+		const uint64_t start_clock = master_clock, start_instructions = instruction_count;
+
+		// only the earlier of the two can end the run, so one event is enough
+		uint64_t budget_end = std::numeric_limits<uint64_t>::max(), stop_time = budget_end;
+		if (conditions.cycles)
+			budget_end = stop_time = master_clock + (*conditions.cycles * CPU_CLOCK_DIVIDER);
+		if (conditions.scanline_dot)
+			stop_time = std::min(stop_time, ppu_event_timestamp(conditions.scanline_dot->first, conditions.scanline_dot->second));
+
+		stop_requested = false;
+		if (stop_time != std::numeric_limits<uint64_t>::max())
+			scheduler.schedule(EventType::StopRun, stop_time);
+
+		if (conditions.write_range)
+		{
+			bus.write_watch = WriteWatch{};
+			bus.write_watch.active = true;
+			bus.write_watch.first = conditions.write_range->first;
+			bus.write_watch.last = conditions.write_range->second;
+		}
+
+		// out of range values never match
+		const uint32_t stop_pc = conditions.pc ? *conditions.pc : 0x10000;
+		const uint32_t stop_frames = conditions.frames.value_or(0);
+		auto finish = [&]()
+		{
+			scheduler.cancel(EventType::StopRun);
+			stop_requested = false;
+			// a hit left behind would stop the next run that doesn't watch writes at once
+			bus.write_watch = WriteWatch{};
+		};
+
+		try
+		{
+			while (true)
+			{
+				if (skip_idle_loops && !bus.trace)
+					skip_idle_loop();
+
+				cpu.step(bus);
+				++instruction_count;
+
+				if (ppu.frame_ended() && ++result.frames == stop_frames)
+				{
+					result.reason = StopReason::Frames;
+					break;
+				}
+				if (stop_requested)
+				{
+					result.reason = master_clock >= budget_end ? StopReason::CycleBudget : StopReason::ScanlineDot;
+					break;
+				}
+				if (bus.write_watch.hit)
+				{
+					result.reason = StopReason::MemoryWrite;
+					result.write_address = bus.write_watch.address;
+					result.write_value = bus.write_watch.value;
+					break;
+				}
+				if (cpu.registers.pc == stop_pc)
+				{
+					result.reason = StopReason::PC;
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			finish();
+			throw;
+		}
+
+		finish();
+		sync_ppu();
+		result.cycles = (master_clock - start_clock) / CPU_CLOCK_DIVIDER;
+		result.instructions = instruction_count - start_instructions;
+		return result;
+	}
+
+	// reads code or ram without touching the clock or any registers, returns nothing for i/o
+	static std::optional<uint8_t> peek(Bus &bus, uint16_t address)
+	{
+		if (const uint8_t *page = bus.memory_map.read_pages[address >> PAGE_SHIFT])
+			return page[address & (PAGE_SIZE - 1)];
+
+		return std::nullopt;
+	}
+
+	// returns how many cpu cycles one pass of the loop starting at pc takes, or 0 when
+	// the loop can't be skipped. only loops whose outcome can't change until the next
+	// scheduled event are accepted:
+	//   JMP *
+	//   Bxx *
+	//   LDA/LDX/LDY/BIT (ram or $2002), Bxx back to the load
+	// ram can only change once the cpu runs other code, which needs an interrupt, and the
+	// vblank flag can only be set by the vblank event. sprite 0 hit and overflow are set
+	// while the ppu renders, so only the N flag may be tested on $2002.
+	uint32_t Core::idle_loop_cycles(uint16_t pc)
+	{
+		const auto opcode = peek(bus, pc);
+		if (!opcode)
+			return 0;
+
+		if (*opcode == 0x4C)
+		{
+			const auto low = peek(bus, pc + 1), high = peek(bus, pc + 2);
+			if (low && high && (*low | (*high << 8)) == pc)
+				return 3;
+			return 0;
+		}
+
+		uint8_t p = cpu.registers.p;
+		uint16_t branch_pc = pc;
+		uint32_t cycles = 0;
+		bool reads_status = false;
+
+		if ((*opcode & 0x1F) != 0x10)
+		{
+			bool is_absolute = false;
+			switch (*opcode)
+			{
+			case 0xA5: // LDA zp
+			case 0xA6: // LDX zp
+			case 0xA4: // LDY zp
+			case 0x24: // BIT zp
+				break;
+			case 0xAD: // LDA abs
+			case 0xAE: // LDX abs
+			case 0xAC: // LDY abs
+			case 0x2C: // BIT abs
+				is_absolute = true;
+				break;
+			default:
+				return 0;
+			}
+
+			const auto low = peek(bus, pc + 1);
+			const auto high = is_absolute ? peek(bus, pc + 2) : std::optional<uint8_t>(0);
+			if (!low || !high)
+				return 0;
+
+			const uint16_t address = *low | (*high << 8);
+			uint8_t value = 0;
+			if (address < 0x2000)
+			{
+				value = bus.internal_ram[address & 0x7FF];
+			}
+			else if ((address & 0xE007) == 0x2002)
+			{
+				// a real pass has to have run first so the read has nothing left to clear
+				if ((ppu.status & PPUStatusFlags::VBlank) || ppu.write_toggle)
+					return 0;
+				value = ppu.status;
+				reads_status = true;
+			}
+			else
+			{
+				return 0;
+			}
+
+			const uint8_t result = *opcode == 0x24 || *opcode == 0x2C ? cpu.registers.a & value : value;
+			p = result == 0 ? p | StatusFlags::Zero : p & ~StatusFlags::Zero;
+			p = value & 0x80 ? p | StatusFlags::Negative : p & ~StatusFlags::Negative;
+			if (*opcode == 0x24 || *opcode == 0x2C)
+				p = (p & ~StatusFlags::Overflow) | (value & StatusFlags::Overflow);
+
+			branch_pc += is_absolute ? 3 : 2;
+			cycles += is_absolute ? 4 : 3;
+		}
+
+		const auto branch = peek(bus, branch_pc), offset = peek(bus, branch_pc + 1);
+		if (!branch || !offset || (*branch & 0x1F) != 0x10)
+			return 0;
+
+		const uint16_t next_pc = branch_pc + 2;
+		if (static_cast<uint16_t>(next_pc + static_cast<int8_t>(*offset)) != pc)
+			return 0;
+
+		// bits 6-7 of a branch opcode select the flag, bit 5 the value that takes it
+		constexpr std::array<uint8_t, 4> BRANCH_FLAGS{
+			StatusFlags::Negative,
+			StatusFlags::Overflow,
+			StatusFlags::Carry,
+			StatusFlags::Zero,
+		};
+		const uint8_t flag = BRANCH_FLAGS[*branch >> 6];
+		if (reads_status && flag != StatusFlags::Negative)
+			return 0;
+		if (((p & flag) != 0) != ((*branch & 0x20) != 0))
+			return 0;
+
+		cycles += (next_pc & 0xFF00) == (pc & 0xFF00) ? 3 : 4;
+		return cycles;
+	}
+
+	void Core::skip_idle_loop()
+	{
+		const uint16_t pc = cpu.registers.pc;
+		const bool looped = pc == recent_pcs[0] || pc == recent_pcs[1];
+		recent_pcs[1] = recent_pcs[0];
+		recent_pcs[0] = pc;
+
+		if (!looped || cpu.reset_pulled || cpu.nmi_ready || cpu.irq_ready || cpu.oam_dma.active)
+			return;
+
+		const uint64_t next_event = scheduler.next_timestamp();
+		if (next_event == std::numeric_limits<uint64_t>::max())
+			return;
+
+		const uint32_t cycles = idle_loop_cycles(pc);
+		if (cycles == 0)
+			return;
+
+		// a pass is skipped only if all of its bus cycles land before the event fires,
+		// the pass that sees the event runs for real
+		const uint64_t pass_length = static_cast<uint64_t>(cycles) * CPU_CLOCK_DIVIDER;
+		if (next_event > master_clock + pass_length)
+		{
+			const uint64_t passes = (next_event - 1 - master_clock) / pass_length;
+			master_clock += passes * pass_length;
+			// a jump or branch to itself takes at most 4 cycles, anything longer is load + branch
+			instruction_count += passes * (cycles <= 4 ? 1 : 2);
+		}
 	}
 }
\ No newline at end of file
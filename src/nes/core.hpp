@@ -2,22 +2,113 @@
 #include "cpu.hpp"
 #include "bus.hpp"
 #include "ppu.hpp"
+#include "scheduler.hpp"
+#include "constants.hpp"
 #include <cinttypes>
 #include <memory>
+#include <array>
+#include <optional>
+#include <utility>
+#include <vector>
 namespace NESterpiece
 {
 	class Cartridge;
+	class StateArchive;
+
+	enum class StopReason
+	{
+		// nothing ran, no condition was set or one was out of range
+		None,
+		CycleBudget,
+		PC,
+		MemoryWrite,
+		ScanlineDot,
+		Frames,
+	};
+
+	// any combination can be set, the first one met ends the run. conditions are looked
+	// at between instructions, one met in the middle of an instruction stops after it
+	struct StopConditions
+	{
+		// cpu cycles to run at most
+		std::optional<uint64_t> cycles;
+		// the next instruction is at pc
+		std::optional<uint16_t> pc;
+		// the cpu wrote to an address in [first, last]
+		std::optional<std::pair<uint16_t, uint16_t>> write_range;
+		// the ppu reached this scanline (0-261) and dot (0-340)
+		std::optional<std::pair<uint16_t, uint16_t>> scanline_dot;
+		// this many frames ended, like calling tick_until_vblank that often
+		std::optional<uint32_t> frames;
+	};
+
+	struct RunResult
+	{
+		StopReason reason = StopReason::None;
+		uint64_t cycles = 0;
+		uint64_t instructions = 0;
+		uint32_t frames = 0;
+		// the write that stopped a MemoryWrite run
+		uint16_t write_address = 0;
+		uint8_t write_value = 0;
+	};
 	class Core
 	{
-		uint8_t cpu_counter = 0, ppu_counter = 0;
+		// the ppu runs behind the cpu and is only caught up when something can observe it.
+		// both clocks are in master cycles
+		uint64_t master_clock = 0, ppu_clock = 0;
+		Scheduler scheduler;
+		// the last two instruction addresses, used to notice one or two instruction loops
+		std::array<uint16_t, 2> recent_pcs{};
+		// set by the StopRun event, checked by run_until between instructions
+		bool stop_requested = false;
+		void run_events(bool read_cycle);
+		void run_ppu_until(uint64_t timestamp);
+		void schedule_ppu_event(EventType type, uint16_t scanline, uint16_t cycle);
+		uint64_t ppu_event_timestamp(uint16_t scanline, uint16_t cycle) const;
+		void run_oam_dma();
+		void skip_idle_loop();
+		uint32_t idle_loop_cycles(uint16_t pc);
 
 	public:
-		CPU cpu;
+		CPU<Bus> cpu;
 		PPU ppu;
 		Bus bus;
+		bool skip_idle_loops = true;
+		// instructions emulated since the last reset, including skipped idle loop passes
+		uint64_t instruction_count = 0;
 		Core();
 		void reset(std::shared_ptr<Cartridge> cart);
-		void tick_components(bool read_cycle);
+		void sync_ppu();
+		void schedule_oam_dma();
 		void tick_until_vblank();
+		// always runs at least one instruction unless nothing is set. the cycle budget and
+		// the ppu position are scheduled as an event, so idle loop skipping stops for them
+		// and nothing extra is checked per cycle
+		RunResult run_until(const StopConditions &conditions);
+
+		// complete machine state as a versioned blob for the loaded cartridge. only valid
+		// between instructions, e.g. after tick_until_vblank
+		static constexpr uint32_t SAVE_STATE_VERSION = 1;
+		size_t state_size();
+		void save_state(std::vector<uint8_t> &out);
+		// false, leaving the machine untouched, when the blob isn't a state of this version
+		// taken with the same kind of cartridge
+		bool load_state(const uint8_t *data, size_t size);
+		void serialize(StateArchive &archive);
+
+		// an independent machine in the same state, sharing only the rom image. goes
+		// through the save state blob, so it's a few microseconds and never allocates once
+		// the target has the cartridge
+		std::unique_ptr<Core> clone();
+		void copy_into(Core &target);
+
+		void tick_components(bool read_cycle)
+		{
+			master_clock += CPU_CLOCK_DIVIDER;
+
+			if (master_clock >= scheduler.next_timestamp())
+				run_events(read_cycle);
+		}
 	};
 }
\ No newline at end of file
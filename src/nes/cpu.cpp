@@ -1,36 +1,30 @@
 #include "cpu.hpp"
 #include "bus.hpp"
+#include "flat_bus.hpp"
 #include "constants.hpp"
+#include "save_state.hpp"
 #include <cassert>
+#include <array>
 
 namespace NESterpiece
 {
-	void CPU::reset_to_address(uint16_t pc)
+	template <CPUBus BusType>
+	void CPU<BusType>::reset_to_address(uint16_t pc)
 	{
-		state = ExecutionState{
-			.branch_taken = false,
-			.data = 0,
-			.address = 0,
-			.addressing_function = nullptr,
-			.operation_function = nullptr,
-		};
+		state = ExecutionState{};
 		registers = Registers();
 		registers.pc = pc;
 		registers.s = 0xFD;
 		next_interrupt_vector = RESET_VECTOR_START;
 		nmi_ready = false;
 		irq_ready = false;
+		reset_pulled = false;
 	}
 
-	void CPU::reset()
+	template <CPUBus BusType>
+	void CPU<BusType>::reset()
 	{
-		state = ExecutionState{
-			.branch_taken = false,
-			.data = 0,
-			.address = 0,
-			.addressing_function = &CPU::adm_interrupt<InterruptType::RESET>,
-			.operation_function = nullptr,
-		};
+		state = ExecutionState{};
 		registers = Registers();
 		next_interrupt_vector = RESET_VECTOR_START;
 		nmi_ready = false;
@@ -38,1057 +32,320 @@ namespace NESterpiece
 		reset_pulled = true;
 	}
 
-	void CPU::step(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::serialize(StateArchive &archive)
 	{
-		if (reset_pulled)
-		{
-			(this->*state.addressing_function)(bus);
-			reset_pulled = false;
-			return;
-		}
-
-		if (check_interrupts())
-		{
-			(this->*state.addressing_function)(bus);
-			//	return;
-		}
-
-		uint8_t opcode = bus.read(registers.pc);
+		archive(state.branch_taken, state.data, state.address);
+		archive(registers.a, registers.x, registers.y, registers.s, registers.p, registers.pc);
+		archive(nmi_ready, irq_ready, reset_pulled, next_interrupt_vector, clock);
+		oam_dma.serialize(archive);
+	}
 
-		state = ExecutionState{
-			.data = 0,
-			.address = 0,
-			.addressing_function = nullptr,
-			.operation_function = nullptr,
-		};
+	template <CPUBus BusType>
+	constexpr std::array<typename CPU<BusType>::cpu_function, 256> CPU<BusType>::build_opcode_table()
+	{
+		std::array<cpu_function, 256> table{};
 
-		registers.pc++;
+		// Illegal/Unimplemented Opcodes
+		table.fill(&CPU::op_illegal);
 
-		switch (opcode)
-		{
 		// LDA
-		case 0xA1:
-		{
-			state.addressing_function = &CPU::adm_indexed_indirect_x<InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::A>;
-			break;
-		}
-		case 0xA5:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::A>;
-			break;
-		}
-		case 0xA9:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_ld_v<TargetValue::A>;
-			break;
-		}
-		case 0xAD:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::A>;
-			break;
-		}
-		case 0xB1:
-		{
-			state.addressing_function = &CPU::adm_indirect_indexed_y<InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::A>;
-			break;
-		}
-		case 0xB5:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::A>;
-			break;
-		}
-		case 0xBD:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::A>;
-			break;
-		}
-		case 0xB9:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::A>;
-			break;
-		}
+		table[0xA1] = &CPU::adm_indexed_indirect_x<InstructionType::Read, &CPU::op_ld_v<TargetValue::A>>;
+		table[0xA5] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_ld_v<TargetValue::A>>;
+		table[0xA9] = &CPU::adm_immediate<&CPU::op_ld_v<TargetValue::A>>;
+		table[0xAD] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_ld_v<TargetValue::A>>;
+		table[0xB1] = &CPU::adm_indirect_indexed_y<InstructionType::Read, &CPU::op_ld_v<TargetValue::A>>;
+		table[0xB5] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read, &CPU::op_ld_v<TargetValue::A>>;
+		table[0xBD] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read, &CPU::op_ld_v<TargetValue::A>>;
+		table[0xB9] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_ld_v<TargetValue::A>>;
 
 		// LDX
-		case 0xA2:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_ld_v<TargetValue::X>;
-			break;
-		}
-		case 0xA6:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::X>;
-			break;
-		}
-		case 0xB6:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::X>;
-			break;
-		}
-		case 0xAE:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::X>;
-			break;
-		}
-		case 0xBE:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::X>;
-			break;
-		}
+		table[0xA2] = &CPU::adm_immediate<&CPU::op_ld_v<TargetValue::X>>;
+		table[0xA6] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_ld_v<TargetValue::X>>;
+		table[0xB6] = &CPU::adm_zero_page_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_ld_v<TargetValue::X>>;
+		table[0xAE] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_ld_v<TargetValue::X>>;
+		table[0xBE] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_ld_v<TargetValue::X>>;
 
 		// LDY
-		case 0xA0:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_ld_v<TargetValue::Y>;
-			break;
-		}
-		case 0xA4:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::Y>;
-			break;
-		}
-		case 0xB4:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::Y>;
-			break;
-		}
-		case 0xAC:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::Y>;
-			break;
-		}
-		case 0xBC:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_ld_v<TargetValue::Y>;
-			break;
-		}
+		table[0xA0] = &CPU::adm_immediate<&CPU::op_ld_v<TargetValue::Y>>;
+		table[0xA4] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_ld_v<TargetValue::Y>>;
+		table[0xB4] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read, &CPU::op_ld_v<TargetValue::Y>>;
+		table[0xAC] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_ld_v<TargetValue::Y>>;
+		table[0xBC] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read, &CPU::op_ld_v<TargetValue::Y>>;
 
 		// EOR
-		case 0x49:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_bitwise<BitOp::XOR>;
-			break;
-		}
-		case 0x45:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::XOR>;
-			break;
-		}
-		case 0x55:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::XOR>;
-			break;
-		}
-		case 0x4D:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::XOR>;
-			break;
-		}
-		case 0x5D:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::XOR>;
-			break;
-		}
-		case 0x59:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::XOR>;
-			break;
-		}
-		case 0x41:
-		{
-			state.addressing_function = &CPU::adm_indexed_indirect_x<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::XOR>;
-			break;
-		}
-		case 0x51:
-		{
-			state.addressing_function = &CPU::adm_indirect_indexed_y<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::XOR>;
-			break;
-		}
+		table[0x49] = &CPU::adm_immediate<&CPU::op_bitwise<BitOp::XOR>>;
+		table[0x45] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_bitwise<BitOp::XOR>>;
+		table[0x55] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read, &CPU::op_bitwise<BitOp::XOR>>;
+		table[0x4D] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_bitwise<BitOp::XOR>>;
+		table[0x5D] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read, &CPU::op_bitwise<BitOp::XOR>>;
+		table[0x59] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_bitwise<BitOp::XOR>>;
+		table[0x41] = &CPU::adm_indexed_indirect_x<InstructionType::Read, &CPU::op_bitwise<BitOp::XOR>>;
+		table[0x51] = &CPU::adm_indirect_indexed_y<InstructionType::Read, &CPU::op_bitwise<BitOp::XOR>>;
 
 		// AND
-		case 0x29:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_bitwise<BitOp::AND>;
-			break;
-		}
-		case 0x25:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::AND>;
-			break;
-		}
-		case 0x35:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::AND>;
-			break;
-		}
-		case 0x2D:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::AND>;
-			break;
-		}
-		case 0x3D:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::AND>;
-			break;
-		}
-		case 0x39:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::AND>;
-			break;
-		}
-		case 0x21:
-		{
-			state.addressing_function = &CPU::adm_indexed_indirect_x<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::AND>;
-			break;
-		}
-		case 0x31:
-		{
-			state.addressing_function = &CPU::adm_indirect_indexed_y<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::AND>;
-			break;
-		}
+		table[0x29] = &CPU::adm_immediate<&CPU::op_bitwise<BitOp::AND>>;
+		table[0x25] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_bitwise<BitOp::AND>>;
+		table[0x35] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read, &CPU::op_bitwise<BitOp::AND>>;
+		table[0x2D] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_bitwise<BitOp::AND>>;
+		table[0x3D] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read, &CPU::op_bitwise<BitOp::AND>>;
+		table[0x39] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_bitwise<BitOp::AND>>;
+		table[0x21] = &CPU::adm_indexed_indirect_x<InstructionType::Read, &CPU::op_bitwise<BitOp::AND>>;
+		table[0x31] = &CPU::adm_indirect_indexed_y<InstructionType::Read, &CPU::op_bitwise<BitOp::AND>>;
 
 		// ORA
-		case 0x09:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_bitwise<BitOp::OR>;
-			break;
-		}
-		case 0x05:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::OR>;
-			break;
-		}
-		case 0x15:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::OR>;
-			break;
-		}
-		case 0x0D:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::OR>;
-			break;
-		}
-		case 0x1D:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::OR>;
-			break;
-		}
-		case 0x19:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::OR>;
-			break;
-		}
-		case 0x01:
-		{
-			state.addressing_function = &CPU::adm_indexed_indirect_x<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::OR>;
-			break;
-		}
-		case 0x11:
-		{
-			state.addressing_function = &CPU::adm_indirect_indexed_y<InstructionType::Read>;
-			state.operation_function = &CPU::op_bitwise<BitOp::OR>;
-			break;
-		}
+		table[0x09] = &CPU::adm_immediate<&CPU::op_bitwise<BitOp::OR>>;
+		table[0x05] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_bitwise<BitOp::OR>>;
+		table[0x15] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read, &CPU::op_bitwise<BitOp::OR>>;
+		table[0x0D] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_bitwise<BitOp::OR>>;
+		table[0x1D] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read, &CPU::op_bitwise<BitOp::OR>>;
+		table[0x19] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_bitwise<BitOp::OR>>;
+		table[0x01] = &CPU::adm_indexed_indirect_x<InstructionType::Read, &CPU::op_bitwise<BitOp::OR>>;
+		table[0x11] = &CPU::adm_indirect_indexed_y<InstructionType::Read, &CPU::op_bitwise<BitOp::OR>>;
 
 		// ADC
-		case 0x69:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_adc;
-			break;
-		}
-		case 0x65:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_adc;
-			break;
-		}
-		case 0x75:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_adc;
-			break;
-		}
-		case 0x6D:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_adc;
-			break;
-		}
-		case 0x7D:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_adc;
-			break;
-		}
-		case 0x79:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_adc;
-			break;
-		}
-		case 0x61:
-		{
-			state.addressing_function = &CPU::adm_indexed_indirect_x<InstructionType::Read>;
-			state.operation_function = &CPU::op_adc;
-			break;
-		}
-		case 0x71:
-		{
-			state.addressing_function = &CPU::adm_indirect_indexed_y<InstructionType::Read>;
-			state.operation_function = &CPU::op_adc;
-			break;
-		}
+		table[0x69] = &CPU::adm_immediate<&CPU::op_adc>;
+		table[0x65] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_adc>;
+		table[0x75] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read, &CPU::op_adc>;
+		table[0x6D] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_adc>;
+		table[0x7D] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read, &CPU::op_adc>;
+		table[0x79] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_adc>;
+		table[0x61] = &CPU::adm_indexed_indirect_x<InstructionType::Read, &CPU::op_adc>;
+		table[0x71] = &CPU::adm_indirect_indexed_y<InstructionType::Read, &CPU::op_adc>;
 
 		// SBC
-		case 0xE9:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_sbc;
-			break;
-		}
-		case 0xE5:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_sbc;
-			break;
-		}
-		case 0xF5:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_sbc;
-			break;
-		}
-		case 0xED:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_sbc;
-			break;
-		}
-		case 0xFD:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_sbc;
-			break;
-		}
-		case 0xF9:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_sbc;
-			break;
-		}
-		case 0xE1:
-		{
-			state.addressing_function = &CPU::adm_indexed_indirect_x<InstructionType::Read>;
-			state.operation_function = &CPU::op_sbc;
-			break;
-		}
-		case 0xF1:
-		{
-			state.addressing_function = &CPU::adm_indirect_indexed_y<InstructionType::Read>;
-			state.operation_function = &CPU::op_sbc;
-			break;
-		}
+		table[0xE9] = &CPU::adm_immediate<&CPU::op_sbc>;
+		table[0xE5] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_sbc>;
+		table[0xF5] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read, &CPU::op_sbc>;
+		table[0xED] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_sbc>;
+		table[0xFD] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read, &CPU::op_sbc>;
+		table[0xF9] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_sbc>;
+		table[0xE1] = &CPU::adm_indexed_indirect_x<InstructionType::Read, &CPU::op_sbc>;
+		table[0xF1] = &CPU::adm_indirect_indexed_y<InstructionType::Read, &CPU::op_sbc>;
 
 		// CMP
-		case 0xC9:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::A>;
-			break;
-		}
-		case 0xC5:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::A>;
-			break;
-		}
-		case 0xD5:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::A>;
-			break;
-		}
-		case 0xCD:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::A>;
-			break;
-		}
-		case 0xDD:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::A>;
-			break;
-		}
-		case 0xD9:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::A>;
-			break;
-		}
-		case 0xC1:
-		{
-			state.addressing_function = &CPU::adm_indexed_indirect_x<InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::A>;
-			break;
-		}
-		case 0xD1:
-		{
-			state.addressing_function = &CPU::adm_indirect_indexed_y<InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::A>;
-			break;
-		}
+		table[0xC9] = &CPU::adm_immediate<&CPU::op_cmp_v<TargetValue::A>>;
+		table[0xC5] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_cmp_v<TargetValue::A>>;
+		table[0xD5] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Read, &CPU::op_cmp_v<TargetValue::A>>;
+		table[0xCD] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_cmp_v<TargetValue::A>>;
+		table[0xDD] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Read, &CPU::op_cmp_v<TargetValue::A>>;
+		table[0xD9] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Read, &CPU::op_cmp_v<TargetValue::A>>;
+		table[0xC1] = &CPU::adm_indexed_indirect_x<InstructionType::Read, &CPU::op_cmp_v<TargetValue::A>>;
+		table[0xD1] = &CPU::adm_indirect_indexed_y<InstructionType::Read, &CPU::op_cmp_v<TargetValue::A>>;
 
 		// CPX
-		case 0xE0:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::X>;
-			break;
-		}
-		case 0xE4:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::X>;
-			break;
-		}
-		case 0xEC:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::X>;
-			break;
-		}
+		table[0xE0] = &CPU::adm_immediate<&CPU::op_cmp_v<TargetValue::X>>;
+		table[0xE4] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_cmp_v<TargetValue::X>>;
+		table[0xEC] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_cmp_v<TargetValue::X>>;
 
 		// CPY
-		case 0xC0:
-		{
-			state.addressing_function = &CPU::adm_immediate;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::Y>;
-			break;
-		}
-		case 0xC4:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::Y>;
-			break;
-		}
-		case 0xCC:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_cmp_v<TargetValue::Y>;
-			break;
-		}
+		table[0xC0] = &CPU::adm_immediate<&CPU::op_cmp_v<TargetValue::Y>>;
+		table[0xC4] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_cmp_v<TargetValue::Y>>;
+		table[0xCC] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_cmp_v<TargetValue::Y>>;
 
 		// BIT
-		case 0x24:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Read>;
-			state.operation_function = &CPU::op_bit;
-			break;
-		}
-		case 0x2C:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Read>;
-			state.operation_function = &CPU::op_bit;
-			break;
-		}
+		table[0x24] = &CPU::adm_zero_page<InstructionType::Read, &CPU::op_bit>;
+		table[0x2C] = &CPU::adm_absolute<InstructionType::Read, &CPU::op_bit>;
 
 		// STA
-		case 0x85:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::A>;
-			break;
-		}
-		case 0x95:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::A>;
-			break;
-		}
-		case 0x8D:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::A>;
-			break;
-		}
-		case 0x9D:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::A>;
-			break;
-		}
-		case 0x99:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::A>;
-			break;
-		}
-		case 0x81:
-		{
-			state.addressing_function = &CPU::adm_indexed_indirect_x<InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::A>;
-			break;
-		}
-		case 0x91:
-		{
-			state.addressing_function = &CPU::adm_indirect_indexed_y<InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::A>;
-			break;
-		}
+		table[0x85] = &CPU::adm_zero_page<InstructionType::Write, &CPU::op_st_v<TargetValue::A>>;
+		table[0x95] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Write, &CPU::op_st_v<TargetValue::A>>;
+		table[0x8D] = &CPU::adm_absolute<InstructionType::Write, &CPU::op_st_v<TargetValue::A>>;
+		table[0x9D] = &CPU::adm_absolute_indexed<TargetValue::X, InstructionType::Write, &CPU::op_st_v<TargetValue::A>>;
+		table[0x99] = &CPU::adm_absolute_indexed<TargetValue::Y, InstructionType::Write, &CPU::op_st_v<TargetValue::A>>;
+		table[0x81] = &CPU::adm_indexed_indirect_x<InstructionType::Write, &CPU::op_st_v<TargetValue::A>>;
+		table[0x91] = &CPU::adm_indirect_indexed_y<InstructionType::Write, &CPU::op_st_v<TargetValue::A>>;
 
 		// STX
-		case 0x86:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::X>;
-			break;
-		}
-		case 0x96:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::Y, InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::X>;
-			break;
-		}
-		case 0x8E:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::X>;
-			break;
-		}
+		table[0x86] = &CPU::adm_zero_page<InstructionType::Write, &CPU::op_st_v<TargetValue::X>>;
+		table[0x96] = &CPU::adm_zero_page_indexed<TargetValue::Y, InstructionType::Write, &CPU::op_st_v<TargetValue::X>>;
+		table[0x8E] = &CPU::adm_absolute<InstructionType::Write, &CPU::op_st_v<TargetValue::X>>;
 
 		// STY
-		case 0x84:
-		{
-			state.addressing_function = &CPU::adm_zero_page<InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::Y>;
-			break;
-		}
-		case 0x94:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::Y>;
-			break;
-		}
-		case 0x8C:
-		{
-			state.addressing_function = &CPU::adm_absolute<InstructionType::Write>;
-			state.operation_function = &CPU::op_st_v<TargetValue::Y>;
-			break;
-		}
+		table[0x84] = &CPU::adm_zero_page<InstructionType::Write, &CPU::op_st_v<TargetValue::Y>>;
+		table[0x94] = &CPU::adm_zero_page_indexed<TargetValue::X, InstructionType::Write, &CPU::op_st_v<TargetValue::Y>>;
+		table[0x8C] = &CPU::adm_absolute<InstructionType::Write, &CPU::op_st_v<TargetValue::Y>>;
 
 		// INC
-		case 0xE6:
-		{
-			state.addressing_function = &CPU::adm_zero_page_rmw;
-			state.operation_function = &CPU::op_inc_v<TargetValue::M>;
-			break;
-		}
-		case 0xF6:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed_rmw;
-			state.operation_function = &CPU::op_inc_v<TargetValue::M>;
-			break;
-		}
-		case 0xEE:
-		{
-			state.addressing_function = &CPU::adm_absolute_rmw;
-			state.operation_function = &CPU::op_inc_v<TargetValue::M>;
-			break;
-		}
-		case 0xFE:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed_rmw;
-			state.operation_function = &CPU::op_inc_v<TargetValue::M>;
-			break;
-		}
+		table[0xE6] = &CPU::adm_zero_page_rmw<&CPU::op_inc_v<TargetValue::M>>;
+		table[0xF6] = &CPU::adm_zero_page_indexed_rmw<&CPU::op_inc_v<TargetValue::M>>;
+		table[0xEE] = &CPU::adm_absolute_rmw<&CPU::op_inc_v<TargetValue::M>>;
+		table[0xFE] = &CPU::adm_absolute_indexed_rmw<&CPU::op_inc_v<TargetValue::M>>;
 
 		// INX
-		case 0xE8:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_inc_v<TargetValue::X>;
-			break;
-		}
+		table[0xE8] = &CPU::adm_implied<&CPU::op_inc_v<TargetValue::X>>;
 
 		// INY
-		case 0xC8:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_inc_v<TargetValue::Y>;
-			break;
-		}
+		table[0xC8] = &CPU::adm_implied<&CPU::op_inc_v<TargetValue::Y>>;
 
 		// DEC
-		case 0xC6:
-		{
-			state.addressing_function = &CPU::adm_zero_page_rmw;
-			state.operation_function = &CPU::op_dec_v<TargetValue::M>;
-			break;
-		}
-		case 0xD6:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed_rmw;
-			state.operation_function = &CPU::op_dec_v<TargetValue::M>;
-			break;
-		}
-		case 0xCE:
-		{
-			state.addressing_function = &CPU::adm_absolute_rmw;
-			state.operation_function = &CPU::op_dec_v<TargetValue::M>;
-			break;
-		}
-		case 0xDE:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed_rmw;
-			state.operation_function = &CPU::op_dec_v<TargetValue::M>;
-			break;
-		}
+		table[0xC6] = &CPU::adm_zero_page_rmw<&CPU::op_dec_v<TargetValue::M>>;
+		table[0xD6] = &CPU::adm_zero_page_indexed_rmw<&CPU::op_dec_v<TargetValue::M>>;
+		table[0xCE] = &CPU::adm_absolute_rmw<&CPU::op_dec_v<TargetValue::M>>;
+		table[0xDE] = &CPU::adm_absolute_indexed_rmw<&CPU::op_dec_v<TargetValue::M>>;
 
 		// DEX
-		case 0xCA:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_dec_v<TargetValue::X>;
-			break;
-		}
+		table[0xCA] = &CPU::adm_implied<&CPU::op_dec_v<TargetValue::X>>;
 
 		// DEY
-		case 0x88:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_dec_v<TargetValue::Y>;
-			break;
-		}
+		table[0x88] = &CPU::adm_implied<&CPU::op_dec_v<TargetValue::Y>>;
 
 		// CLC
-		case 0x18:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_clear_f<StatusFlags::Carry>;
-			break;
-		}
+		table[0x18] = &CPU::adm_implied<&CPU::op_clear_f<StatusFlags::Carry>>;
 
 		// CLD
-		case 0xD8:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_clear_f<StatusFlags::Decimal>;
-			break;
-		}
+		table[0xD8] = &CPU::adm_implied<&CPU::op_clear_f<StatusFlags::Decimal>>;
 
 		// CLI
-		case 0x58:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_clear_f<StatusFlags::IRQ>;
-			break;
-		}
+		table[0x58] = &CPU::adm_implied<&CPU::op_clear_f<StatusFlags::IRQ>>;
 
 		// CLV
-		case 0xB8:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_clear_f<StatusFlags::Overflow>;
-			break;
-		}
+		table[0xB8] = &CPU::adm_implied<&CPU::op_clear_f<StatusFlags::Overflow>>;
 
 		// SEC
-		case 0x38:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_set_f<StatusFlags::Carry>;
-			break;
-		}
+		table[0x38] = &CPU::adm_implied<&CPU::op_set_f<StatusFlags::Carry>>;
 
 		// SED
-		case 0xF8:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_set_f<StatusFlags::Decimal>;
-			break;
-		}
+		table[0xF8] = &CPU::adm_implied<&CPU::op_set_f<StatusFlags::Decimal>>;
 
 		// SEI
-		case 0x78:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_set_f<StatusFlags::IRQ>;
-			break;
-		}
+		table[0x78] = &CPU::adm_implied<&CPU::op_set_f<StatusFlags::IRQ>>;
 
 		// TAX
-		case 0xAA:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_transfer_vv<TargetValue::A, TargetValue::X>;
-			break;
-		}
+		table[0xAA] = &CPU::adm_implied<&CPU::op_transfer_vv<TargetValue::A, TargetValue::X>>;
 
 		// TAY
-		case 0xA8:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_transfer_vv<TargetValue::A, TargetValue::Y>;
-			break;
-		}
+		table[0xA8] = &CPU::adm_implied<&CPU::op_transfer_vv<TargetValue::A, TargetValue::Y>>;
 
 		// TSX
-		case 0xBA:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_transfer_vv<TargetValue::S, TargetValue::X>;
-			break;
-		}
+		table[0xBA] = &CPU::adm_implied<&CPU::op_transfer_vv<TargetValue::S, TargetValue::X>>;
 
 		// TXA
-		case 0x8A:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_transfer_vv<TargetValue::X, TargetValue::A>;
-			break;
-		}
+		table[0x8A] = &CPU::adm_implied<&CPU::op_transfer_vv<TargetValue::X, TargetValue::A>>;
 
 		// TXS
-		case 0x9A:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_transfer_vv<TargetValue::X, TargetValue::S>;
-			break;
-		}
+		table[0x9A] = &CPU::adm_implied<&CPU::op_transfer_vv<TargetValue::X, TargetValue::S>>;
 
 		// TYA
-		case 0x98:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_transfer_vv<TargetValue::Y, TargetValue::A>;
-			break;
-		}
+		table[0x98] = &CPU::adm_implied<&CPU::op_transfer_vv<TargetValue::Y, TargetValue::A>>;
 
 		// PHA
-		case 0x48:
-		{
-			state.addressing_function = &CPU::adm_pha_php;
-			state.operation_function = &CPU::op_push_v<TargetValue::A>;
-			break;
-		}
+		table[0x48] = &CPU::adm_pha_php<&CPU::op_push_v<TargetValue::A>>;
 
 		// PHP
-		case 0x08:
-		{
-			state.addressing_function = &CPU::adm_pha_php;
-			state.operation_function = &CPU::op_push_v<TargetValue::P>;
-			break;
-		}
+		table[0x08] = &CPU::adm_pha_php<&CPU::op_push_v<TargetValue::P>>;
 
 		// PLA
-		case 0x68:
-		{
-			state.addressing_function = &CPU::adm_pla_plp;
-			state.operation_function = &CPU::op_pop_v<TargetValue::A>;
-			break;
-		}
+		table[0x68] = &CPU::adm_pla_plp<&CPU::op_pop_v<TargetValue::A>>;
 
 		// PLP
-		case 0x28:
-		{
-			state.addressing_function = &CPU::adm_pla_plp;
-			state.operation_function = &CPU::op_pop_v<TargetValue::P>;
-			break;
-		}
+		table[0x28] = &CPU::adm_pla_plp<&CPU::op_pop_v<TargetValue::P>>;
 
 		// ASL
-		case 0x0A:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_asl_v<TargetValue::A>;
-			break;
-		}
-		case 0x06:
-		{
-			state.addressing_function = &CPU::adm_zero_page_rmw;
-			state.operation_function = &CPU::op_asl_v<TargetValue::M>;
-			break;
-		}
-		case 0x16:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed_rmw;
-			state.operation_function = &CPU::op_asl_v<TargetValue::M>;
-			break;
-		}
-		case 0x0E:
-		{
-			state.addressing_function = &CPU::adm_absolute_rmw;
-			state.operation_function = &CPU::op_asl_v<TargetValue::M>;
-			break;
-		}
-		case 0x1E:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed_rmw;
-			state.operation_function = &CPU::op_asl_v<TargetValue::M>;
-			break;
-		}
+		table[0x0A] = &CPU::adm_implied<&CPU::op_asl_v<TargetValue::A>>;
+		table[0x06] = &CPU::adm_zero_page_rmw<&CPU::op_asl_v<TargetValue::M>>;
+		table[0x16] = &CPU::adm_zero_page_indexed_rmw<&CPU::op_asl_v<TargetValue::M>>;
+		table[0x0E] = &CPU::adm_absolute_rmw<&CPU::op_asl_v<TargetValue::M>>;
+		table[0x1E] = &CPU::adm_absolute_indexed_rmw<&CPU::op_asl_v<TargetValue::M>>;
 
 		// LSR
-		case 0x4A:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_lsr_v<TargetValue::A>;
-			break;
-		}
-		case 0x46:
-		{
-			state.addressing_function = &CPU::adm_zero_page_rmw;
-			state.operation_function = &CPU::op_lsr_v<TargetValue::M>;
-			break;
-		}
-		case 0x56:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed_rmw;
-			state.operation_function = &CPU::op_lsr_v<TargetValue::M>;
-			break;
-		}
-		case 0x4E:
-		{
-			state.addressing_function = &CPU::adm_absolute_rmw;
-			state.operation_function = &CPU::op_lsr_v<TargetValue::M>;
-			break;
-		}
-		case 0x5E:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed_rmw;
-			state.operation_function = &CPU::op_lsr_v<TargetValue::M>;
-			break;
-		}
+		table[0x4A] = &CPU::adm_implied<&CPU::op_lsr_v<TargetValue::A>>;
+		table[0x46] = &CPU::adm_zero_page_rmw<&CPU::op_lsr_v<TargetValue::M>>;
+		table[0x56] = &CPU::adm_zero_page_indexed_rmw<&CPU::op_lsr_v<TargetValue::M>>;
+		table[0x4E] = &CPU::adm_absolute_rmw<&CPU::op_lsr_v<TargetValue::M>>;
+		table[0x5E] = &CPU::adm_absolute_indexed_rmw<&CPU::op_lsr_v<TargetValue::M>>;
 
 		// ROL
-		case 0x2A:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_rol_v<TargetValue::A>;
-			break;
-		}
-		case 0x26:
-		{
-			state.addressing_function = &CPU::adm_zero_page_rmw;
-			state.operation_function = &CPU::op_rol_v<TargetValue::M>;
-			break;
-		}
-		case 0x36:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed_rmw;
-			state.operation_function = &CPU::op_rol_v<TargetValue::M>;
-			break;
-		}
-		case 0x2E:
-		{
-			state.addressing_function = &CPU::adm_absolute_rmw;
-			state.operation_function = &CPU::op_rol_v<TargetValue::M>;
-			break;
-		}
-		case 0x3E:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed_rmw;
-			state.operation_function = &CPU::op_rol_v<TargetValue::M>;
-			break;
-		}
+		table[0x2A] = &CPU::adm_implied<&CPU::op_rol_v<TargetValue::A>>;
+		table[0x26] = &CPU::adm_zero_page_rmw<&CPU::op_rol_v<TargetValue::M>>;
+		table[0x36] = &CPU::adm_zero_page_indexed_rmw<&CPU::op_rol_v<TargetValue::M>>;
+		table[0x2E] = &CPU::adm_absolute_rmw<&CPU::op_rol_v<TargetValue::M>>;
+		table[0x3E] = &CPU::adm_absolute_indexed_rmw<&CPU::op_rol_v<TargetValue::M>>;
 
 		// ROR
-		case 0x6A:
-		{
-			state.addressing_function = &CPU::adm_implied<false>;
-			state.operation_function = &CPU::op_ror_v<TargetValue::A>;
-			break;
-		}
-		case 0x66:
-		{
-			state.addressing_function = &CPU::adm_zero_page_rmw;
-			state.operation_function = &CPU::op_ror_v<TargetValue::M>;
-			break;
-		}
-		case 0x76:
-		{
-			state.addressing_function = &CPU::adm_zero_page_indexed_rmw;
-			state.operation_function = &CPU::op_ror_v<TargetValue::M>;
-			break;
-		}
-		case 0x6E:
-		{
-			state.addressing_function = &CPU::adm_absolute_rmw;
-			state.operation_function = &CPU::op_ror_v<TargetValue::M>;
-			break;
-		}
-		case 0x7E:
-		{
-			state.addressing_function = &CPU::adm_absolute_indexed_rmw;
-			state.operation_function = &CPU::op_ror_v<TargetValue::M>;
-			break;
-		}
+		table[0x6A] = &CPU::adm_implied<&CPU::op_ror_v<TargetValue::A>>;
+		table[0x66] = &CPU::adm_zero_page_rmw<&CPU::op_ror_v<TargetValue::M>>;
+		table[0x76] = &CPU::adm_zero_page_indexed_rmw<&CPU::op_ror_v<TargetValue::M>>;
+		table[0x6E] = &CPU::adm_absolute_rmw<&CPU::op_ror_v<TargetValue::M>>;
+		table[0x7E] = &CPU::adm_absolute_indexed_rmw<&CPU::op_ror_v<TargetValue::M>>;
 
 		// BCC
-		case 0x90:
-		{
-			state.addressing_function = &CPU::adm_relative;
-			state.operation_function = &CPU::op_branch_cs<StatusFlags::Carry, false>;
-			break;
-		}
+		table[0x90] = &CPU::adm_relative<&CPU::op_branch_cs<StatusFlags::Carry, false>>;
 
 		// BCS
-		case 0xB0:
-		{
-			state.addressing_function = &CPU::adm_relative;
-			state.operation_function = &CPU::op_branch_cs<StatusFlags::Carry, true>;
-			break;
-		}
+		table[0xB0] = &CPU::adm_relative<&CPU::op_branch_cs<StatusFlags::Carry, true>>;
 
 		// BEQ
-		case 0xF0:
-		{
-			state.addressing_function = &CPU::adm_relative;
-			state.operation_function = &CPU::op_branch_cs<StatusFlags::Zero, true>;
-			break;
-		}
+		table[0xF0] = &CPU::adm_relative<&CPU::op_branch_cs<StatusFlags::Zero, true>>;
 
 		// BMI
-		case 0x30:
-		{
-			state.addressing_function = &CPU::adm_relative;
-			state.operation_function = &CPU::op_branch_cs<StatusFlags::Negative, true>;
-			break;
-		}
+		table[0x30] = &CPU::adm_relative<&CPU::op_branch_cs<StatusFlags::Negative, true>>;
 
 		// BNE
-		case 0xD0:
-		{
-			state.addressing_function = &CPU::adm_relative;
-			state.operation_function = &CPU::op_branch_cs<StatusFlags::Zero, false>;
-			break;
-		}
+		table[0xD0] = &CPU::adm_relative<&CPU::op_branch_cs<StatusFlags::Zero, false>>;
 
 		// BPL
-		case 0x10:
-		{
-			state.addressing_function = &CPU::adm_relative;
-			state.operation_function = &CPU::op_branch_cs<StatusFlags::Negative, false>;
-			break;
-		}
+		table[0x10] = &CPU::adm_relative<&CPU::op_branch_cs<StatusFlags::Negative, false>>;
 
 		// BVC
-		case 0x50:
-		{
-			state.addressing_function = &CPU::adm_relative;
-			state.operation_function = &CPU::op_branch_cs<StatusFlags::Overflow, false>;
-			break;
-		}
+		table[0x50] = &CPU::adm_relative<&CPU::op_branch_cs<StatusFlags::Overflow, false>>;
 
 		// BVS
-		case 0x70:
-		{
-			state.addressing_function = &CPU::adm_relative;
-			state.operation_function = &CPU::op_branch_cs<StatusFlags::Overflow, true>;
-			break;
-		}
+		table[0x70] = &CPU::adm_relative<&CPU::op_branch_cs<StatusFlags::Overflow, true>>;
 
 		// BRK
-		case 0x00:
-		{
-			state.addressing_function = &CPU::adm_interrupt<InterruptType::BRK>;
-			break;
-		}
+		table[0x00] = &CPU::adm_interrupt<InterruptType::BRK>;
 
 		// RTI
-		case 0x40:
-		{
-			state.addressing_function = &CPU::adm_rti;
-			break;
-		}
+		table[0x40] = &CPU::adm_rti;
 
 		// JSR
-		case 0x20:
-		{
-			state.addressing_function = &CPU::adm_jsr;
-			break;
-		}
+		table[0x20] = &CPU::adm_jsr;
 
 		// RTS
-		case 0x60:
-		{
-			state.addressing_function = &CPU::adm_rts;
-			break;
-		}
+		table[0x60] = &CPU::adm_rts;
 
 		// JMP
-		case 0x4C:
-		{
-			state.addressing_function = &CPU::adm_absolute_jmp;
-			break;
-		}
-		case 0x6C:
-		{
-			state.addressing_function = &CPU::adm_absolute_indirect_jmp;
-			break;
-		}
+		table[0x4C] = &CPU::adm_absolute_jmp;
+		table[0x6C] = &CPU::adm_absolute_indirect_jmp;
 
 		// NOP
-		case 0xEA:
-		{
-			state.addressing_function = &CPU::adm_implied<true>;
-			break;
-		}
+		table[0xEA] = &CPU::adm_implied<nullptr>;
+
+		return table;
+	}
 
-		default: // Illegal/Unimplemented Opcodes
+	template <CPUBus BusType>
+	constexpr auto opcode_table = CPU<BusType>::build_opcode_table();
+
+	template <CPUBus BusType>
+	void CPU<BusType>::step(BusType &bus)
+	{
+		if (reset_pulled)
 		{
-			throw "Bad Opcode";
+			adm_interrupt<InterruptType::RESET>(bus);
+			reset_pulled = false;
 			return;
 		}
-		}
 
-		(this->*state.addressing_function)(bus);
+		check_interrupts(bus);
+
+		uint8_t opcode = bus.read(registers.pc);
+		state = ExecutionState{};
+		registers.pc++;
+
+		(this->*opcode_table<BusType>[opcode])(bus);
+	}
+
+	template <CPUBus BusType>
+	void CPU<BusType>::op_illegal(BusType &bus)
+	{
+		throw "Bad Opcode";
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_ld_v(Bus &bus)
+	void CPU<BusType>::op_ld_v(BusType &bus)
 	{
 		auto data = static_cast<uint8_t>(state.data & 0xFF);
 		registers.p = data == 0 ? registers.p | StatusFlags::Zero : registers.p & ~StatusFlags::Zero;
@@ -1110,8 +367,9 @@ namespace NESterpiece
 		}
 	}
 
+	template <CPUBus BusType>
 	template <BitOp bit_op>
-	void CPU::op_bitwise(Bus &bus)
+	void CPU<BusType>::op_bitwise(BusType &bus)
 	{
 		auto data = static_cast<uint8_t>(state.data & 0xFF);
 
@@ -1132,7 +390,8 @@ namespace NESterpiece
 		registers.p = registers.a & StatusFlags::Negative ? registers.p | StatusFlags::Negative : registers.p & ~StatusFlags::Negative;
 	}
 
-	void CPU::op_adc(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::op_adc(BusType &bus)
 	{
 		uint16_t data = state.data & 0xFF;
 		uint16_t result = registers.a + data + (registers.p & StatusFlags::Carry ? 1 : 0);
@@ -1147,14 +406,16 @@ namespace NESterpiece
 		registers.a = static_cast<uint8_t>(result);
 	}
 
-	void CPU::op_sbc(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::op_sbc(BusType &bus)
 	{
 		state.data = ~state.data;
 		op_adc(bus);
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_cmp_v(Bus &bus)
+	void CPU<BusType>::op_cmp_v(BusType &bus)
 	{
 		uint8_t reg = 0;
 		switch (val)
@@ -1184,7 +445,8 @@ namespace NESterpiece
 			registers.p |= result | StatusFlags::Carry;
 	}
 
-	void CPU::op_bit(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::op_bit(BusType &bus)
 	{
 		auto data = static_cast<uint8_t>(state.data & 0xFF);
 		uint8_t result = registers.a & data;
@@ -1194,8 +456,9 @@ namespace NESterpiece
 		registers.p |= data & 0xC0;
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_st_v(Bus &bus)
+	void CPU<BusType>::op_st_v(BusType &bus)
 	{
 		uint8_t reg = 0;
 		switch (val)
@@ -1215,8 +478,9 @@ namespace NESterpiece
 		state.data = reg;
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_inc_v(Bus &bus)
+	void CPU<BusType>::op_inc_v(BusType &bus)
 	{
 		uint8_t result = 0;
 		switch (val)
@@ -1246,8 +510,9 @@ namespace NESterpiece
 		registers.p = result & StatusFlags::Negative ? registers.p | StatusFlags::Negative : registers.p & ~StatusFlags::Negative;
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_dec_v(Bus &bus)
+	void CPU<BusType>::op_dec_v(BusType &bus)
 	{
 		uint8_t result = 0;
 		switch (val)
@@ -1277,20 +542,23 @@ namespace NESterpiece
 		registers.p = result & StatusFlags::Negative ? registers.p | StatusFlags::Negative : registers.p & ~StatusFlags::Negative;
 	}
 
+	template <CPUBus BusType>
 	template <StatusFlags flag>
-	void CPU::op_clear_f(Bus &bus)
+	void CPU<BusType>::op_clear_f(BusType &bus)
 	{
 		registers.p &= ~flag;
 	}
 
+	template <CPUBus BusType>
 	template <StatusFlags flag>
-	void CPU::op_set_f(Bus &bus)
+	void CPU<BusType>::op_set_f(BusType &bus)
 	{
 		registers.p |= flag;
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue src, TargetValue dst>
-	void CPU::op_transfer_vv(Bus &bus)
+	void CPU<BusType>::op_transfer_vv(BusType &bus)
 	{
 		uint8_t *src_value = nullptr, *dst_value = nullptr;
 		switch (src)
@@ -1338,8 +606,9 @@ namespace NESterpiece
 		}
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_push_v(Bus &bus)
+	void CPU<BusType>::op_push_v(BusType &bus)
 	{
 		switch (val)
 		{
@@ -1355,8 +624,9 @@ namespace NESterpiece
 		}
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_pop_v(Bus &bus)
+	void CPU<BusType>::op_pop_v(BusType &bus)
 	{
 		switch (val)
 		{
@@ -1379,8 +649,9 @@ namespace NESterpiece
 		}
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_asl_v(Bus &bus)
+	void CPU<BusType>::op_asl_v(BusType &bus)
 	{
 		uint8_t out = 0;
 		switch (val)
@@ -1410,8 +681,9 @@ namespace NESterpiece
 		registers.p = out & StatusFlags::Negative ? registers.p | StatusFlags::Negative : registers.p & ~StatusFlags::Negative;
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_lsr_v(Bus &bus)
+	void CPU<BusType>::op_lsr_v(BusType &bus)
 	{
 		uint8_t out = 0;
 		switch (val)
@@ -1441,8 +713,9 @@ namespace NESterpiece
 		registers.p &= ~StatusFlags::Negative;
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_rol_v(Bus &bus)
+	void CPU<BusType>::op_rol_v(BusType &bus)
 	{
 		uint8_t out = 0, out_carry = 0;
 
@@ -1476,8 +749,9 @@ namespace NESterpiece
 		registers.p = out & StatusFlags::Negative ? registers.p | StatusFlags::Negative : registers.p & ~StatusFlags::Negative;
 	}
 
+	template <CPUBus BusType>
 	template <TargetValue val>
-	void CPU::op_ror_v(Bus &bus)
+	void CPU<BusType>::op_ror_v(BusType &bus)
 	{
 		uint8_t out = 0, out_carry = 0;
 
@@ -1511,14 +785,16 @@ namespace NESterpiece
 		registers.p = out & StatusFlags::Negative ? registers.p | StatusFlags::Negative : registers.p & ~StatusFlags::Negative;
 	}
 
+	template <CPUBus BusType>
 	template <StatusFlags cond, bool set>
-	void CPU::op_branch_cs(Bus &bus)
+	void CPU<BusType>::op_branch_cs(BusType &bus)
 	{
 		state.branch_taken = set ? (registers.p & cond) : !(registers.p & cond);
 	}
 
+	template <CPUBus BusType>
 	template <InterruptType int_type>
-	void CPU::adm_interrupt(Bus &bus)
+	void CPU<BusType>::adm_interrupt(BusType &bus)
 	{
 		bus.read(registers.pc);
 		if constexpr (int_type == InterruptType::BRK)
@@ -1568,7 +844,8 @@ namespace NESterpiece
 		registers.pc = state.address;
 	}
 
-	void CPU::adm_rti(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::adm_rti(BusType &bus)
 	{
 		state.data = bus.read(registers.pc);
 
@@ -1585,7 +862,8 @@ namespace NESterpiece
 		registers.pc = state.address;
 	}
 
-	void CPU::adm_jsr(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::adm_jsr(BusType &bus)
 	{
 		state.data = bus.read(registers.pc);
 		registers.pc++;
@@ -1604,7 +882,8 @@ namespace NESterpiece
 		registers.pc = (pch << 8) | pcl;
 	}
 
-	void CPU::adm_rts(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::adm_rts(BusType &bus)
 	{
 		bus.read(registers.pc);
 
@@ -1621,12 +900,14 @@ namespace NESterpiece
 		registers.pc++;
 	}
 
-	void CPU::adm_relative(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_relative(BusType &bus)
 	{
 		state.data = bus.read(registers.pc);
 		registers.pc++;
 
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 		bool page_crossed = false;
 		if (state.branch_taken)
 		{
@@ -1656,16 +937,20 @@ namespace NESterpiece
 		}
 	}
 
-	void CPU::adm_pha_php(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_pha_php(BusType &bus)
 	{
 		bus.read(registers.pc);
 
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 		bus.write(static_cast<uint16_t>(registers.s) | 0x100, state.data);
 		registers.s--;
 	}
 
-	void CPU::adm_pla_plp(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_pla_plp(BusType &bus)
 	{
 		bus.read(registers.pc);
 
@@ -1673,26 +958,30 @@ namespace NESterpiece
 		registers.s++;
 
 		state.data = bus.read(static_cast<uint16_t>(registers.s) | 0x100);
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 	}
 
-	template <bool is_nop>
-	void CPU::adm_implied(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_implied(BusType &bus)
 	{
 		bus.read(registers.pc);
-		if constexpr (!is_nop)
-			(this->*state.operation_function)(bus);
+		if constexpr (operation != nullptr)
+			(this->*operation)(bus);
 	}
 
-	void CPU::adm_immediate(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_immediate(BusType &bus)
 	{
 		state.data = bus.read(registers.pc);
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 		registers.pc++;
 	}
 
-	template <InstructionType type>
-	void CPU::adm_zero_page(Bus &bus)
+	template <CPUBus BusType>
+	template <InstructionType type, typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_zero_page(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1700,16 +989,18 @@ namespace NESterpiece
 		if constexpr (type == InstructionType::Read)
 		{
 			state.data = bus.read(state.address);
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 		}
 		else if constexpr (type == InstructionType::Write)
 		{
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 			bus.write(state.address, state.data);
 		}
 	}
 
-	void CPU::adm_zero_page_rmw(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_zero_page_rmw(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1717,13 +1008,14 @@ namespace NESterpiece
 		state.data = bus.read(state.address);
 
 		bus.write(state.address, state.data);
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 
 		bus.write(state.address, state.data);
 	}
 
-	template <TargetValue reg, InstructionType type>
-	void CPU::adm_zero_page_indexed(Bus &bus)
+	template <CPUBus BusType>
+	template <TargetValue reg, InstructionType type, typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_zero_page_indexed(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1740,16 +1032,18 @@ namespace NESterpiece
 		if constexpr (type == InstructionType::Read)
 		{
 			state.data = bus.read(state.address);
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 		}
 		else if constexpr (type == InstructionType::Write)
 		{
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 			bus.write(state.address, state.data);
 		}
 	}
 
-	void CPU::adm_zero_page_indexed_rmw(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_zero_page_indexed_rmw(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1761,13 +1055,14 @@ namespace NESterpiece
 		state.data = bus.read(state.address);
 
 		bus.write(state.address, state.data);
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 
 		bus.write(state.address, state.data);
 	}
 
-	template <InstructionType type>
-	void CPU::adm_absolute(Bus &bus)
+	template <CPUBus BusType>
+	template <InstructionType type, typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_absolute(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1778,16 +1073,18 @@ namespace NESterpiece
 		if constexpr (type == InstructionType::Read)
 		{
 			state.data = bus.read(state.address);
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 		}
 		else if constexpr (type == InstructionType::Write)
 		{
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 			bus.write(state.address, state.data);
 		}
 	}
 
-	void CPU::adm_absolute_rmw(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_absolute_rmw(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1798,12 +1095,13 @@ namespace NESterpiece
 		state.data = bus.read(state.address);
 
 		bus.write(state.address, state.data);
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 
 		bus.write(state.address, state.data);
 	}
 
-	void CPU::adm_absolute_jmp(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::adm_absolute_jmp(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1812,7 +1110,8 @@ namespace NESterpiece
 		registers.pc = state.address;
 	}
 
-	void CPU::adm_absolute_indirect_jmp(Bus &bus)
+	template <CPUBus BusType>
+	void CPU<BusType>::adm_absolute_indirect_jmp(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1831,8 +1130,9 @@ namespace NESterpiece
 		registers.pc = state.data;
 	}
 
-	template <TargetValue reg, InstructionType type>
-	void CPU::adm_absolute_indexed(Bus &bus)
+	template <CPUBus BusType>
+	template <TargetValue reg, InstructionType type, typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_absolute_indexed(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1868,7 +1168,7 @@ namespace NESterpiece
 		{
 			if constexpr (type == InstructionType::Read)
 			{
-				(this->*state.operation_function)(bus);
+				(this->*operation)(bus);
 				return;
 			}
 		}
@@ -1876,16 +1176,18 @@ namespace NESterpiece
 		if constexpr (type == InstructionType::Read)
 		{
 			state.data = bus.read(state.address);
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 		}
 		else if constexpr (type == InstructionType::Write)
 		{
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 			bus.write(state.address, state.data);
 		}
 	}
 
-	void CPU::adm_absolute_indexed_rmw(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_absolute_indexed_rmw(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1914,12 +1216,13 @@ namespace NESterpiece
 
 		bus.write(state.address, state.data);
 
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 		bus.write(state.address, state.data);
 	}
 
-	template <InstructionType type>
-	void CPU::adm_indexed_indirect_x(Bus &bus)
+	template <CPUBus BusType>
+	template <InstructionType type, typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_indexed_indirect_x(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1936,16 +1239,18 @@ namespace NESterpiece
 		if constexpr (type == InstructionType::Read)
 		{
 			state.data = bus.read(state.address);
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 		}
 		else if constexpr (type == InstructionType::Write)
 		{
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 			bus.write(state.address, state.data);
 		}
 	}
 
-	void CPU::adm_indexed_indirect_x_rmw(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_indexed_indirect_x_rmw(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -1962,13 +1267,14 @@ namespace NESterpiece
 		state.data = bus.read(state.address);
 
 		bus.write(state.address, state.data);
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 
 		bus.write(state.address, state.data);
 	}
 
-	template <InstructionType type>
-	void CPU::adm_indirect_indexed_y(Bus &bus)
+	template <CPUBus BusType>
+	template <InstructionType type, typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_indirect_indexed_y(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -2003,7 +1309,7 @@ namespace NESterpiece
 		{
 			if constexpr (type == InstructionType::Read)
 			{
-				(this->*state.operation_function)(bus);
+				(this->*operation)(bus);
 				return;
 			}
 		}
@@ -2011,16 +1317,18 @@ namespace NESterpiece
 		if constexpr (type == InstructionType::Read)
 		{
 			state.data = bus.read(state.address);
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 		}
 		else if constexpr (type == InstructionType::Write)
 		{
-			(this->*state.operation_function)(bus);
+			(this->*operation)(bus);
 			bus.write(state.address, state.data);
 		}
 	}
 
-	void CPU::adm_indirect_indexed_y_rmw(Bus &bus)
+	template <CPUBus BusType>
+	template <typename CPU<BusType>::cpu_function operation>
+	void CPU<BusType>::adm_indirect_indexed_y_rmw(BusType &bus)
 	{
 		state.address = bus.read(registers.pc);
 		registers.pc++;
@@ -2055,40 +1363,28 @@ namespace NESterpiece
 		state.data = bus.read(state.address);
 
 		bus.write(state.address, state.data);
-		(this->*state.operation_function)(bus);
+		(this->*operation)(bus);
 
 		bus.write(state.address, state.data);
 	}
 
-	bool CPU::check_interrupts()
+	template <CPUBus BusType>
+	bool CPU<BusType>::check_interrupts(BusType &bus)
 	{
-
 		if (nmi_ready)
 		{
-			state = ExecutionState{
-				.branch_taken = false,
-				.data = 0,
-				.address = 0,
-				.addressing_function = nullptr,
-				.operation_function = nullptr,
-			};
-			state.addressing_function = &CPU::adm_interrupt<InterruptType::NMI>;
-
+			adm_interrupt<InterruptType::NMI>(bus);
 			return true;
 		}
 		else if (irq_ready && !(registers.p & StatusFlags::IRQ))
 		{
-			state = ExecutionState{
-				.branch_taken = false,
-				.data = 0,
-				.address = 0,
-				.addressing_function = nullptr,
-				.operation_function = nullptr,
-			};
-			state.addressing_function = &CPU::adm_interrupt<InterruptType::IRQ>;
+			adm_interrupt<InterruptType::IRQ>(bus);
 			return true;
 		}
 
 		return false;
 	}
+
+	template class CPU<Bus>;
+	template class CPU<FlatBus>;
 }
\ No newline at end of file
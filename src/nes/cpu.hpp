@@ -2,10 +2,18 @@
 #include "oam.hpp"
 #include "constants.hpp"
 #include <cinttypes>
+#include <array>
+#include <concepts>
 
 namespace NESterpiece
 {
-	class Bus;
+	class StateArchive;
+
+	template <class T>
+	concept CPUBus = requires(T &bus, uint16_t address, uint8_t value) {
+		{ bus.read(address) } -> std::convertible_to<uint8_t>;
+		bus.write(address, value);
+	};
 
 	enum StatusFlags
 	{
@@ -50,25 +58,21 @@ namespace NESterpiece
 		BRK
 	};
 
+	template <CPUBus BusType>
 	class CPU
 	{
-		using cpu_function = void (CPU::*)(Bus &);
+	public:
+		using cpu_function = void (CPU::*)(BusType &);
+
+	private:
 		struct ExecutionState
 		{
 			bool branch_taken = false;
 			uint16_t data = 0;
 			uint16_t address = 0;
-			cpu_function addressing_function = nullptr, operation_function = nullptr;
 		};
 
-		ExecutionState state{
-			.branch_taken = false,
-			//	.page_crossed = true,
-			.data = 0,
-			.address = 0,
-			.addressing_function = nullptr,
-			.operation_function = nullptr,
-		};
+		ExecutionState state{};
 
 	public:
 		bool nmi_ready = false, irq_ready = false, reset_pulled = true;
@@ -83,76 +87,90 @@ namespace NESterpiece
 
 		void reset_to_address(uint16_t pc);
 		void reset();
-		void step(Bus &bus);
+		void serialize(StateArchive &archive);
+		void step(BusType &bus);
+		void op_illegal(BusType &bus);
 		template <TargetValue val>
-		void op_ld_v(Bus &bus);
+		void op_ld_v(BusType &bus);
 		template <BitOp bit_op>
-		void op_bitwise(Bus &bus);
-		void op_adc(Bus &bus);
-		void op_sbc(Bus &bus);
+		void op_bitwise(BusType &bus);
+		void op_adc(BusType &bus);
+		void op_sbc(BusType &bus);
 		template <TargetValue val>
-		void op_cmp_v(Bus &bus);
-		void op_bit(Bus &bus);
+		void op_cmp_v(BusType &bus);
+		void op_bit(BusType &bus);
 		template <TargetValue val>
-		void op_st_v(Bus &bus);
+		void op_st_v(BusType &bus);
 		template <TargetValue val>
-		void op_inc_v(Bus &bus);
+		void op_inc_v(BusType &bus);
 		template <TargetValue val>
-		void op_dec_v(Bus &bus);
+		void op_dec_v(BusType &bus);
 		template <StatusFlags flag>
-		void op_clear_f(Bus &bus);
+		void op_clear_f(BusType &bus);
 		template <StatusFlags flag>
-		void op_set_f(Bus &bus);
+		void op_set_f(BusType &bus);
 		template <TargetValue src, TargetValue dst>
-		void op_transfer_vv(Bus &bus);
+		void op_transfer_vv(BusType &bus);
 		template <TargetValue val>
-		void op_push_v(Bus &bus);
+		void op_push_v(BusType &bus);
 		template <TargetValue val>
-		void op_pop_v(Bus &bus);
+		void op_pop_v(BusType &bus);
 		template <TargetValue val>
-		void op_asl_v(Bus &bus);
+		void op_asl_v(BusType &bus);
 		template <TargetValue val>
-		void op_lsr_v(Bus &bus);
+		void op_lsr_v(BusType &bus);
 		template <TargetValue val>
-		void op_rol_v(Bus &bus);
+		void op_rol_v(BusType &bus);
 		template <TargetValue val>
-		void op_ror_v(Bus &bus);
+		void op_ror_v(BusType &bus);
 		template <StatusFlags cond, bool set>
-		void op_branch_cs(Bus &bus);
+		void op_branch_cs(BusType &bus);
 
+		// every addressing mode is instantiated together with the operation it
+		// runs, so a single table entry covers a whole instruction
 		template <InterruptType int_type>
-		void adm_interrupt(Bus &bus);
-		void adm_rti(Bus &bus);
-		void adm_jsr(Bus &bus);
-		void adm_rts(Bus &bus);
-		void adm_relative(Bus &bus);
-		void adm_pha_php(Bus &bus);
-		void adm_pla_plp(Bus &bus);
-		template <bool is_nop>
-		void adm_implied(Bus &bus);
-		void adm_immediate(Bus &bus);
-		template <InstructionType type>
-		void adm_zero_page(Bus &bus);
-		void adm_zero_page_rmw(Bus &bus);
-		template <TargetValue reg, InstructionType type>
-		void adm_zero_page_indexed(Bus &bus);
-		void adm_zero_page_indexed_rmw(Bus &bus);
-		template <InstructionType type>
-		void adm_absolute(Bus &bus);
-		void adm_absolute_rmw(Bus &bus);
-		void adm_absolute_jmp(Bus &bus);
-		void adm_absolute_indirect_jmp(Bus &bus);
-		template <TargetValue reg, InstructionType type>
-		void adm_absolute_indexed(Bus &bus);
-		void adm_absolute_indexed_rmw(Bus &bus);
-		template <InstructionType type>
-		void adm_indexed_indirect_x(Bus &bus);
-		void adm_indexed_indirect_x_rmw(Bus &bus);
-		template <InstructionType type>
-		void adm_indirect_indexed_y(Bus &bus);
-		void adm_indirect_indexed_y_rmw(Bus &bus);
+		void adm_interrupt(BusType &bus);
+		void adm_rti(BusType &bus);
+		void adm_jsr(BusType &bus);
+		void adm_rts(BusType &bus);
+		template <cpu_function operation>
+		void adm_relative(BusType &bus);
+		template <cpu_function operation>
+		void adm_pha_php(BusType &bus);
+		template <cpu_function operation>
+		void adm_pla_plp(BusType &bus);
+		template <cpu_function operation>
+		void adm_implied(BusType &bus);
+		template <cpu_function operation>
+		void adm_immediate(BusType &bus);
+		template <InstructionType type, cpu_function operation>
+		void adm_zero_page(BusType &bus);
+		template <cpu_function operation>
+		void adm_zero_page_rmw(BusType &bus);
+		template <TargetValue reg, InstructionType type, cpu_function operation>
+		void adm_zero_page_indexed(BusType &bus);
+		template <cpu_function operation>
+		void adm_zero_page_indexed_rmw(BusType &bus);
+		template <InstructionType type, cpu_function operation>
+		void adm_absolute(BusType &bus);
+		template <cpu_function operation>
+		void adm_absolute_rmw(BusType &bus);
+		void adm_absolute_jmp(BusType &bus);
+		void adm_absolute_indirect_jmp(BusType &bus);
+		template <TargetValue reg, InstructionType type, cpu_function operation>
+		void adm_absolute_indexed(BusType &bus);
+		template <cpu_function operation>
+		void adm_absolute_indexed_rmw(BusType &bus);
+		template <InstructionType type, cpu_function operation>
+		void adm_indexed_indirect_x(BusType &bus);
+		template <cpu_function operation>
+		void adm_indexed_indirect_x_rmw(BusType &bus);
+		template <InstructionType type, cpu_function operation>
+		void adm_indirect_indexed_y(BusType &bus);
+		template <cpu_function operation>
+		void adm_indirect_indexed_y_rmw(BusType &bus);
 
-		bool check_interrupts();
-		void decode(uint8_t opcode);
+		bool check_interrupts(BusType &bus);
+		static constexpr std::array<cpu_function, 256> build_opcode_table();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include "bus_activity.hpp"
+#include <cinttypes>
+#include <array>
+#include <vector>
+
+namespace NESterpiece
+{
+	// 64 KiB of plain memory with no attached components, used to run the CPU
+	// on its own (CPU tests, benchmarks).
+	class FlatBus
+	{
+	public:
+		std::array<uint8_t, 0x10000> memory{};
+		bool record_activity = false;
+		std::vector<BusActivity> activity_list{};
+
+		uint8_t read(uint16_t address)
+		{
+			const uint8_t value = memory[address];
+			if (record_activity)
+			{
+				activity_list.push_back({
+					.value = value,
+					.address = address,
+					.type = BusActivityType::Read,
+				});
+			}
+
+			return value;
+		}
+
+		void write(uint16_t address, uint8_t value)
+		{
+			memory[address] = value;
+			if (record_activity)
+			{
+				activity_list.push_back({
+					.value = value,
+					.address = address,
+					.type = BusActivityType::Write,
+				});
+			}
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <cinttypes>
+#include "chr_cache.hpp"
+#include <array>
+
+namespace NESterpiece
+{
+	constexpr uint16_t PAGE_SIZE = 0x400;
+	constexpr uint16_t PAGE_SHIFT = 10;
+
+	// an address space split into 1 KiB pages. a page that points at plain memory is
+	// accessed directly, a null page falls back to the owner's handlers
+	template <uint32_t AddressSpace>
+	class PageTable
+	{
+	public:
+		std::array<const uint8_t *, AddressSpace / PAGE_SIZE> read_pages{};
+		std::array<uint8_t *, AddressSpace / PAGE_SIZE> write_pages{};
+
+		void clear(uint16_t start, uint16_t end)
+		{
+			for (uint32_t page = start >> PAGE_SHIFT; page <= (end >> PAGE_SHIFT); ++page)
+				read_pages[page] = write_pages[page] = nullptr;
+		}
+
+		// maps [start, end] to memory, wrapping around every `size` bytes for mirrors
+		void map(uint16_t start, uint16_t end, uint8_t *memory, uint32_t size, bool writable)
+		{
+			for (uint32_t address = start; address <= end; address += PAGE_SIZE)
+			{
+				uint8_t *page = memory + ((address - start) % size);
+				read_pages[address >> PAGE_SHIFT] = page;
+				write_pages[address >> PAGE_SHIFT] = writable ? page : nullptr;
+			}
+		}
+
+		// same for memory that is never written through the table, like shared rom
+		void map(uint16_t start, uint16_t end, const uint8_t *memory, uint32_t size)
+		{
+			for (uint32_t address = start; address <= end; address += PAGE_SIZE)
+			{
+				read_pages[address >> PAGE_SHIFT] = memory + ((address - start) % size);
+				write_pages[address >> PAGE_SHIFT] = nullptr;
+			}
+		}
+	};
+
+	// cpu address space
+	using MemoryMap = PageTable<0x10000>;
+
+	// ppu address space, pattern tables and nametables. palettes are never paged.
+	// pattern table pages also carry their decoded rows, null when there are none
+	class VideoMemoryMap : public PageTable<0x4000>
+	{
+	public:
+		std::array<const TileRow *, 0x2000 / PAGE_SIZE> pattern_rows{};
+	};
+}
@@ -0,0 +1,157 @@
+#include "movie.hpp"
+#include "core.hpp"
+#include "state_hash.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+namespace NESterpiece
+{
+	namespace
+	{
+		struct MovieHeader
+		{
+			uint32_t magic = Movie::MAGIC;
+			uint32_t version = Movie::VERSION;
+			uint64_t rom_hash = 0;
+			uint32_t frame_count = 0;
+			uint32_t state_size = 0;
+		};
+		static_assert(sizeof(MovieHeader) == 24, "the header is written as raw bytes");
+
+		void write_run(std::vector<uint8_t> &out, uint8_t buttons, uint32_t length)
+		{
+			// the length as a base 128 varint, almost every run fits in one or two bytes
+			out.push_back(buttons);
+			do
+			{
+				const uint8_t low = length & 0x7F;
+				length >>= 7;
+				out.push_back(length ? low | 0x80 : low);
+			} while (length);
+		}
+
+		// reset keeps ram and part of the cpu and ppu like the console's button does, a
+		// freshly built machine is the only reproducible starting point
+		void power_on(Core &core)
+		{
+			auto fresh = std::make_unique<Core>();
+			fresh->reset(Cartridge::from_image(core.bus.cart->rom));
+			fresh->copy_into(core);
+		}
+	}
+
+	uint64_t hash_rom(const RomImage &rom)
+	{
+		// the header decides the mapper and the mirroring
+		StateHash hash;
+		hash.add(rom.header.flags_6.data);
+		hash.add(rom.header.flags_7.data);
+		hash.add(rom.header.m_info.data);
+		hash.add(rom.prg_rom.data(), rom.prg_rom.size());
+		hash.add(rom.chr_rom.data(), rom.chr_rom.size());
+		return hash.result();
+	}
+
+	Movie Movie::start_recording(Core &core, bool from_power_on)
+	{
+		Movie movie;
+		movie.rom_hash = hash_rom(*core.bus.cart->rom);
+		if (from_power_on)
+			power_on(core);
+		else
+			core.save_state(movie.start_state);
+		return movie;
+	}
+
+	bool Movie::start_playback(Core &core) const
+	{
+		if (!core.bus.cart || hash_rom(*core.bus.cart->rom) != rom_hash)
+			return false;
+
+		if (start_state.empty())
+		{
+			power_on(core);
+			return true;
+		}
+
+		// a fresh cartridge so nothing of the previous run survives in its ram
+		core.reset(Cartridge::from_image(core.bus.cart->rom));
+		return core.load_state(start_state.data(), start_state.size());
+	}
+
+	bool Movie::save(const std::string &path) const
+	{
+		MovieHeader header;
+		header.rom_hash = rom_hash;
+		header.frame_count = static_cast<uint32_t>(buttons.size());
+		header.state_size = static_cast<uint32_t>(start_state.size());
+
+		std::vector<uint8_t> data(sizeof(header));
+		std::memcpy(data.data(), &header, sizeof(header));
+		data.insert(data.end(), start_state.begin(), start_state.end());
+
+		for (size_t i = 0; i < buttons.size();)
+		{
+			size_t end = i + 1;
+			while (end < buttons.size() && buttons[end] == buttons[i])
+				++end;
+
+			write_run(data, buttons[i], static_cast<uint32_t>(end - i));
+			i = end;
+		}
+
+		std::ofstream file(path, std::ios::binary);
+		file.write(reinterpret_cast<const char *>(data.data()), data.size());
+		return file.good();
+	}
+
+	std::optional<Movie> Movie::load(const std::string &path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return std::nullopt;
+
+		const std::vector<uint8_t> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+		MovieHeader header;
+		if (data.size() < sizeof(header))
+			return std::nullopt;
+
+		std::memcpy(&header, data.data(), sizeof(header));
+		if (header.magic != MAGIC || header.version != VERSION || data.size() - sizeof(header) < header.state_size)
+			return std::nullopt;
+
+		Movie movie;
+		movie.rom_hash = header.rom_hash;
+		const uint8_t *position = data.data() + sizeof(header);
+		const uint8_t *end = data.data() + data.size();
+		movie.start_state.assign(position, position + header.state_size);
+		position += header.state_size;
+
+		movie.buttons.reserve(header.frame_count);
+		while (position != end)
+		{
+			const uint8_t buttons = *position++;
+			uint32_t length = 0;
+			for (uint32_t shift = 0;; shift += 7)
+			{
+				if (position == end || shift > 28)
+					return std::nullopt;
+
+				const uint8_t byte = *position++;
+				length |= static_cast<uint32_t>(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					break;
+			}
+
+			if (length > header.frame_count - movie.buttons.size())
+				return std::nullopt;
+			movie.buttons.insert(movie.buttons.end(), length, buttons);
+		}
+
+		if (movie.buttons.size() != header.frame_count)
+			return std::nullopt;
+		return movie;
+	}
+}
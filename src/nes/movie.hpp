@@ -0,0 +1,44 @@
+#pragma once
+#include "cartridge.hpp"
+#include <cinttypes>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace NESterpiece
+{
+	class Core;
+
+	// fingerprint of the prg and chr rom, a movie only plays back on the rom it was made with
+	uint64_t hash_rom(const RomImage &rom);
+
+	// the controller input for every frame from a fixed start, either power on or an
+	// embedded save state. frame n is run with buttons[n] latched for its whole duration,
+	// the same way the frontend and the batch runner feed input
+	class Movie
+	{
+	public:
+		static constexpr uint32_t MAGIC = 0x4D53454E; // "NESM"
+		static constexpr uint32_t VERSION = 1;
+
+		uint64_t rom_hash = 0;
+		// empty when the movie starts from power on
+		std::vector<uint8_t> start_state;
+		std::vector<uint8_t> buttons;
+
+		// an empty movie starting where the core is now, or from power on after resetting it
+		static Movie start_recording(Core &core, bool from_power_on);
+		// puts the core at the start of the movie, fails if it runs a different rom
+		bool start_playback(Core &core) const;
+
+		// past the end nothing is pressed
+		uint8_t frame_buttons(size_t frame) const
+		{
+			return frame < buttons.size() ? buttons[frame] : 0;
+		}
+
+		// header, start state, then the buttons as runs of a byte and its repeat count
+		bool save(const std::string &path) const;
+		static std::optional<Movie> load(const std::string &path);
+	};
+}
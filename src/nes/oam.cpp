@@ -1,9 +1,15 @@
 #include "oam.hpp"
 #include "ppu.hpp"
 #include "bus.hpp"
+#include "save_state.hpp"
 
 namespace NESterpiece
 {
+	void OAMDMA::serialize(StateArchive &archive)
+	{
+		archive(bytes_left, alignment, total_cycles, put_cycle, active, data, address, address_snap);
+	}
+
 	void OAMDMA::start(uint8_t page)
 	{
 		active = true;
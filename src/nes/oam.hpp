@@ -5,6 +5,7 @@ namespace NESterpiece
 {
 	class Bus;
 	class PPU;
+	class StateArchive;
 	class OAMDMA
 	{
 		uint16_t bytes_left = 0;
@@ -18,5 +19,6 @@ namespace NESterpiece
 
 		void start(uint8_t page);
 		void step(Bus &bus, PPU &ppu);
+		void serialize(StateArchive &archive);
 	};
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "pad.hpp"
+#include "save_state.hpp"
 
 namespace NESterpiece
 {
@@ -13,6 +14,16 @@ namespace NESterpiece
 		data_line |= pressed ? btn : 0;
 	}
 
+	void StdController::set_buttons(uint8_t buttons)
+	{
+		data_line = buttons;
+	}
+
+	uint8_t StdController::buttons() const
+	{
+		return data_line;
+	}
+
 	void StdController::capture_state()
 	{
 		if (active)
@@ -36,4 +47,9 @@ namespace NESterpiece
 		captured >>= 1;
 		return out;
 	}
+
+	void StdController::serialize(StateArchive &archive)
+	{
+		archive(captured, data_line, active);
+	}
 }
@@ -3,6 +3,8 @@
 #include <functional>
 namespace NESterpiece
 {
+	class StateArchive;
+
 	// Status for each controller is returned as an 8-bit report in the following order: A, B, Select, Start, Up, Down, Left, Right.
 
 	enum StdControllerButton
@@ -27,9 +29,12 @@ namespace NESterpiece
 		std::function<void(StdController &)> input_poll_cb;
 		void reset();
 		void set_button_state(StdControllerButton btn, bool pressed);
+		void set_buttons(uint8_t buttons);
+		uint8_t buttons() const;
 		void capture_state();
 
 		void write(uint8_t value);
 		uint8_t read_and_shift();
+		void serialize(StateArchive &archive);
 	};
 }
\ No newline at end of file
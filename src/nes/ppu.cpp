@@ -2,7 +2,10 @@
 #include "core.hpp"
 #include "cartridge.hpp"
 #include "constants.hpp"
+#include "save_state.hpp"
 #include <cassert>
+#include <algorithm>
+#include <bit>
 
 namespace NESterpiece
 {
@@ -18,7 +21,7 @@ namespace NESterpiece
 		fetcher = FetcherState{};
 		bg_pixels = BGShiftRegister{};
 		bg_attributes = BGShiftRegister{};
-		oam_shifters.clear();
+		sprite_line.fill(SpritePixel{});
 
 		ctrl = mask = 0;
 		status = PPUStatusFlags::VBlank | PPUStatusFlags::SpriteOverflow;
@@ -26,11 +29,23 @@ namespace NESterpiece
 		frame_num = 0;
 		palette_memory.fill(0);
 		oam.fill(0);
-		framebuffer.fill(0);
+		rebuild_sprite_index();
+		frame = Frame{};
 		w2006_cycles = 0;
 		w2006_delay = false;
 	}
 
+	void PPU::serialize(StateArchive &archive)
+	{
+		archive(write_toggle, _frame_ended, odd, w2006_delay, fine_x_scroll);
+		archive(ctrl, mask, status, oam_address, address, data);
+		archive(v, t, cycles, w2006_cycles, scanline_num, frame_num, total_frame_cycles);
+		archive(fetcher, bg_pixels, bg_attributes, sprite_line, palette_memory, oam);
+
+		if (archive.loading())
+			rebuild_sprite_index();
+	}
+
 	void PPU::update_snapshot()
 	{
 		snapshot.cycles = cycles;
@@ -89,71 +104,38 @@ namespace NESterpiece
 					{
 						if (x_pos > 7)
 						{
-							framebuffer[(scanline_num * 256) + x_pos] = Palette2C02[lookup];
+							frame.pixels[(scanline_num * 256) + x_pos] = output_index(lookup);
 						}
 						else
 						{
-							framebuffer[(scanline_num * 256) + x_pos] = Palette2C02[0];
+							frame.pixels[(scanline_num * 256) + x_pos] = output_index(0);
 							check_sprite0 = false;
 						}
 					}
 					else
 					{
 						if (mask & MaskFlags::ShowBG)
-							framebuffer[(scanline_num * 256) + x_pos] = Palette2C02[lookup];
+							frame.pixels[(scanline_num * 256) + x_pos] = output_index(lookup);
 						else
-							framebuffer[(scanline_num * 256) + x_pos] = Palette2C02[0];
+							frame.pixels[(scanline_num * 256) + x_pos] = output_index(0);
 					}
 
-					if (mask & MaskFlags::ShowSprites)
+					const SpritePixel &sprite = sprite_line[x_pos];
+					const bool sprite_clipped = ((mask & MaskFlags::ShowSpritesOnLeft) == 0) && (x_pos < 8);
+					if ((mask & MaskFlags::ShowSprites) && sprite.palette_address != 0 && !sprite_clipped)
 					{
-						for (auto &shifter : oam_shifters)
-						{
-							if (shifter.x_position > 0)
-							{
-								shifter.x_position--;
-							}
-							else
-							{
-								const uint8_t pixel_attribute = shifter.attribute & 0x3;
-								uint8_t pixel_low = 0;
-								uint8_t pixel_high = 0;
-
-								if (shifter.attribute & ObjectAttribute::FlipX)
-								{
-									pixel_low = shifter.pattern_low & 1;
-									pixel_high = shifter.pattern_high & 1;
-									shifter.pattern_low >>= 1;
-									shifter.pattern_high >>= 1;
-								}
-								else
-								{
-									pixel_low = (shifter.pattern_low >> 7) & 1;
-									pixel_high = (shifter.pattern_high >> 7) & 1;
-									shifter.pattern_low <<= 1;
-									shifter.pattern_high <<= 1;
-								}
-
-								const uint8_t pixel = (pixel_high << 1) | pixel_low;
-
-								uint8_t lookup = ppu_read_v((0x3F10 + (pixel_attribute << 2) + pixel));
-
-								if (((mask & MaskFlags::ShowSpritesOnLeft) == 0) && (x_pos < 8))
-									continue;
-
-								if (pixel > 0)
-								{
-									if (bg_pixel > 0 && shifter.is_sprite0 && x_pos >= 2)
-										status |= PPUStatusFlags::Sprite0Hit;
-
-									if ((shifter.attribute & ObjectAttribute::Priority) == 0 || bg_pixel == 0)
-										framebuffer[(scanline_num * 256) + (cycles - 1)] = Palette2C02[lookup];
-								}
-							}
-						}
+						if (bg_pixel > 0 && sprite.is_sprite0 && x_pos >= 2)
+							status |= PPUStatusFlags::Sprite0Hit;
+
+						if (!sprite.behind_bg || bg_pixel == 0)
+							frame.pixels[(scanline_num * 256) + x_pos] = output_index(ppu_read_v(0x3F00 | sprite.palette_address));
 					}
 				}
 			}
+			else if (scanline_num < 240 && within_range<uint16_t>(cycles, 1, 256))
+			{
+				output_backdrop(cycles - 1, 1);
+			}
 		}
 
 		if (cycles == 256 && within_range<uint16_t>(scanline_num, 0, 239))
@@ -161,20 +143,6 @@ namespace NESterpiece
 			sprite_eval();
 		}
 
-		if (scanline_num == 241 && cycles == 1)
-		{
-			status |= PPUStatusFlags::VBlank;
-			_frame_ended = true;
-			if (ctrl & CtrlFlags::EnableNMI)
-				core.cpu.nmi_ready = true;
-		}
-
-		if (scanline_num == 261 && cycles == 1)
-		{
-			oam_shifters.clear();
-			status &= ~(PPUStatusFlags::VBlank | PPUStatusFlags::Sprite0Hit | PPUStatusFlags::SpriteOverflow);
-		}
-
 		check_snapshots();
 
 		if (w2006_delay && w2006_cycles == 3)
@@ -187,25 +155,166 @@ namespace NESterpiece
 			w2006_cycles++;
 		}
 
-		if (cycles == 339 && scanline_num == 261 && odd && rendering_enabled())
+		if (cycles == 340)
+		{
+			next_scanline();
+		}
+		else
+		{
+			total_frame_cycles++;
 			cycles++;
+		}
+	}
 
-		if (cycles == 340)
+	// dots 1-256 of a visible line can be drawn in one go when nothing will look at the
+	// ppu in between, the core only asks once it knows the cpu can't touch it that long
+	bool PPU::can_render_line() const
+	{
+		if (scanline_num > 239 || cycles != 1 || w2006_delay)
+			return false;
+
+		switch (update_event)
 		{
-			cycles = 0;
-			scanline_num = ++scanline_num % 262;
-			if (scanline_num == 0)
+		case SnapshotEvent::OnFrame:
+			return frame_num != trigger_frame;
+		case SnapshotEvent::OnScanlineCycle:
+			return trigger_scanline != scanline_num || !within_range<uint16_t>(trigger_cycle, 1, 256);
+		default:
+			return true;
+		}
+	}
+
+	// same output as 256 calls to step(), but the background is laid out a tile at a time
+	// and the sprite line is laid over it afterwards
+	void PPU::render_line()
+	{
+		if (rendering_enabled())
+		{
+			// the background shifters as a stream of pixels: the first 16 entries are the
+			// registers as they are now, msb first, and the tile loaded at dot 8n+1 lands on
+			// entries 8n+9 to 8n+16. the pixel drawn at x is entry fine_x + x + 1
+			std::array<uint8_t, 272> bg_stream{}, attribute_stream{};
+			for (uint16_t i = 0; i < 16; ++i)
 			{
-				odd = !odd;
-				total_frame_cycles = 0;
-				frame_num++;
+				bg_stream[i] = (((bg_pixels.high >> (15 - i)) & 1) << 1) | ((bg_pixels.low >> (15 - i)) & 1);
+				attribute_stream[i] = (((bg_attributes.high >> (15 - i)) & 1) << 1) | ((bg_attributes.low >> (15 - i)) & 1);
+			}
+
+			TileRow row = decode_tile_row(fetcher.low, fetcher.high);
+			uint16_t pattern_address = 0;
+			for (uint16_t tile = 0; tile < 32; ++tile)
+			{
+				const uint16_t start = (tile * 8) + 9;
+				for (uint16_t i = 0; i < 8; ++i)
+				{
+					bg_stream[start + i] |= row[i];
+					attribute_stream[start + i] |= fetcher.tile_attribute;
+				}
+
+				fetcher.nametable_tile = read_video(0x2000 | (v & 0x0FFF));
+				fetch_attribute();
+				pattern_address = bg_pattern_address();
+				row = fetch_row(pattern_address);
+				increment_x();
+			}
+			increment_y();
+
+			fetcher.low = read_video(pattern_address);
+			fetcher.high = read_video(pattern_address + 8);
+
+			// after 256 shifts bit n of the registers holds entry 271 - n
+			bg_pixels = BGShiftRegister{};
+			bg_attributes = BGShiftRegister{};
+			for (uint16_t bit = 0; bit < 16; ++bit)
+			{
+				bg_pixels.low |= (bg_stream[271 - bit] & 1) << bit;
+				bg_pixels.high |= (bg_stream[271 - bit] >> 1) << bit;
+				bg_attributes.low |= (attribute_stream[271 - bit] & 1) << bit;
+				bg_attributes.high |= (attribute_stream[271 - bit] >> 1) << bit;
+			}
+
+			const uint8_t *bg_line = &bg_stream[fine_x_scroll + 1];
+			const uint8_t *attribute_line = &attribute_stream[fine_x_scroll + 1];
+			uint16_t *color_line = &frame.pixels[scanline_num * 256];
+			const bool show_bg = (mask & MaskFlags::ShowBG) || (mask & MaskFlags::ShowBGOnLeft) == 0;
+			const uint8_t left_edge = (mask & MaskFlags::ShowBGOnLeft) == 0 ? 8 : 0;
+			if (output_enabled)
+			{
+				for (uint16_t x = 0; x < 256; ++x)
+				{
+					const uint8_t lookup = palette_memory[bg_line[x] == 0 ? 0 : (attribute_line[x] << 2) | bg_line[x]];
+					color_line[x] = show_bg && x >= left_edge ? lookup : 0;
+				}
+			}
+
+			if (mask & MaskFlags::ShowSprites)
+			{
+				for (uint16_t x = (mask & MaskFlags::ShowSpritesOnLeft) ? 0 : 8; x < 256; ++x)
+				{
+					const SpritePixel &sprite = sprite_line[x];
+					if (sprite.palette_address == 0)
+						continue;
+
+					if (bg_line[x] > 0 && sprite.is_sprite0 && x >= 2)
+						status |= PPUStatusFlags::Sprite0Hit;
+
+					if (output_enabled && (!sprite.behind_bg || bg_line[x] == 0))
+						color_line[x] = palette_memory[sprite.palette_address];
+				}
+			}
+
+			if (output_enabled)
+			{
+				const uint16_t index_mask = mask & MaskFlags::Grayscale ? 0x30 : 0x3F;
+				const uint16_t emphasis = (mask >> 5) << 6;
+				for (uint16_t x = 0; x < 256; ++x)
+					color_line[x] = (color_line[x] & index_mask) | emphasis;
 			}
 		}
 		else
 		{
-			total_frame_cycles++;
-			cycles++;
+			output_backdrop(0, 256);
 		}
+
+		sprite_eval();
+
+		cycles = 257;
+		total_frame_cycles += 256;
+		w2006_cycles += 256;
+	}
+
+	void PPU::next_scanline()
+	{
+		cycles = 0;
+		scanline_num = ++scanline_num % 262;
+		if (scanline_num == 0)
+		{
+			odd = !odd;
+			total_frame_cycles = 0;
+			frame_num++;
+		}
+	}
+
+	// the following are run by the core's scheduler right before the ppu steps
+	// through the dot they belong to, except skip_odd_dot which runs right after
+	void PPU::start_vblank()
+	{
+		status |= PPUStatusFlags::VBlank;
+		_frame_ended = true;
+		if (ctrl & CtrlFlags::EnableNMI)
+			core.cpu.nmi_ready = true;
+	}
+
+	void PPU::start_prerender()
+	{
+		sprite_line.fill(SpritePixel{});
+		status &= ~(PPUStatusFlags::VBlank | PPUStatusFlags::Sprite0Hit | PPUStatusFlags::SpriteOverflow);
+	}
+
+	void PPU::skip_odd_dot()
+	{
+		if (odd && rendering_enabled())
+			next_scanline();
 	}
 
 	void PPU::check_snapshots()
@@ -231,55 +340,60 @@ namespace NESterpiece
 		}
 	}
 
+	// lays out the sprites that cover the next line into sprite_line. lower oam entries
+	// are in front, so a pixel is only taken if no earlier sprite is opaque there
 	void PPU::sprite_eval()
 	{
 		const uint16_t scanline = scanline_num;
 		const bool large_sprites = ctrl & CtrlFlags::OAMSize;
 		const uint16_t height = large_sprites ? 16 : 8;
 
-		oam_shifters.clear();
-		for (size_t i = 0, num_objects = 0; i < oam.size() / 4; ++i)
-		{
+		sprite_line.fill(SpritePixel{});
 
-			const uint16_t y_pos = oam[i * 4];
+		// every sprite whose top is within height - 1 lines above this one covers it
+		uint64_t candidates = 0;
+		for (uint16_t y = scanline >= height ? scanline - (height - 1) : 0; y <= scanline; ++y)
+			candidates |= sprites_at_y[y];
 
-			if (y_pos <= scanline && (y_pos + height) > scanline)
+		for (size_t num_objects = 0; candidates != 0; candidates &= candidates - 1)
+		{
+			const size_t i = std::countr_zero(candidates);
+			const uint16_t y_pos = oam[i * 4];
+			if (num_objects == 8)
 			{
-				if (oam_shifters.size() == 8)
-				{
-					status |= PPUStatusFlags::SpriteOverflow;
-					break;
-				}
+				status |= PPUStatusFlags::SpriteOverflow;
+				break;
+			}
+			++num_objects;
 
-				ObjectShiftRegister shifter{
-					.is_sprite0 = i == 0,
-					.attribute = oam[(i * 4) + 2],
-					.x_position = oam[(i * 4) + 3],
-					.pattern_low = 0,
-					.pattern_high = 0,
-				};
+			const uint8_t attribute = oam[(i * 4) + 2];
+			const uint8_t x_position = oam[(i * 4) + 3];
+			uint8_t tile = oam[(i * 4) + 1];
+			uint8_t pattern_table = ctrl & CtrlFlags::OAMPatternAddress;
 
-				uint8_t tile = oam[(i * 4) + 1];
-				uint8_t pattern_table = ctrl & CtrlFlags::OAMPatternAddress;
+			if (large_sprites)
+			{
+				pattern_table = tile & 1;
+				tile = tile & (~1);
+			}
 
-				if (large_sprites)
-				{
-					pattern_table = tile & 1;
-					tile = tile & (~1);
-				}
+			const uint16_t fine_y = attribute & ObjectAttribute::FlipY ? (height - 1) - (scanline - y_pos) : scanline - y_pos;
+			TileRow pixels = fetch_row(((pattern_table & 1) << 12) | (tile << 4) | (fine_y & 7));
+			if (attribute & ObjectAttribute::FlipX)
+				std::reverse(pixels.begin(), pixels.end());
 
-				if (shifter.attribute & ObjectAttribute::FlipY)
-				{
-					shifter.pattern_low = core.bus.cart->read_chr(pattern_table, tile, 0, (height - 1) - (scanline - y_pos));
-					shifter.pattern_high = core.bus.cart->read_chr(pattern_table, tile, 1, (height - 1) - (scanline - y_pos));
-				}
-				else
-				{
-					shifter.pattern_low = core.bus.cart->read_chr(pattern_table, tile, 0, scanline - y_pos);
-					shifter.pattern_high = core.bus.cart->read_chr(pattern_table, tile, 1, scanline - y_pos);
-				}
+			const uint8_t palette = 0x10 | ((attribute & ObjectAttribute::Palette) << 2);
+			for (uint16_t column = 0; column < 8 && x_position + column < 256; ++column)
+			{
+				SpritePixel &out = sprite_line[x_position + column];
+				if (pixels[column] == 0 || out.palette_address != 0)
+					continue;
 
-				oam_shifters.push_back(std::move(shifter));
+				out = SpritePixel{
+					.palette_address = static_cast<uint8_t>(palette | pixels[column]),
+					.behind_bg = (attribute & ObjectAttribute::Priority) != 0,
+					.is_sprite0 = i == 0,
+				};
 			}
 		}
 	}
@@ -301,40 +415,47 @@ namespace NESterpiece
 			// fill shift register with the same attribute bits for all pixels
 			bg_attributes.low |= fetcher.tile_attribute & 0b1 ? 0xFF : 0x0;
 			bg_attributes.high |= fetcher.tile_attribute & 0b10 ? 0xFF : 0x0;
-			fetcher.nametable_tile = ppu_read_v(0x2000 | (v & 0x0FFF));
+			fetcher.nametable_tile = read_video(0x2000 | (v & 0x0FFF));
 			break;
 		}
 		case 3:
 		{
-			const uint8_t attribute = ppu_read_v(0x23C0 | (v & 0x0C00) | ((v >> 4) & 0x38) | ((v >> 2) & 0x07));
-			const uint8_t row = ((v & VramMask::CoarseY) >> 4) & 0x4;
-			const uint8_t column = (v & VramMask::CoarseX) & 0x2;
-
-			// if row 1 is selected then shift the bottom tiles up front
-			// then select between column 1 or 2 and mask the result
-			fetcher.tile_attribute = (attribute >> (row | column)) & 0x3;
+			fetch_attribute();
 			break;
 		}
 		case 5:
 		{
-			const auto pattern_table = static_cast<uint16_t>(ctrl & CtrlFlags::BGPatternAddress) << 8;
-			const auto tile = static_cast<uint16_t>(fetcher.nametable_tile) << 4;
-			const uint16_t fine_y = (v & VramMask::FineY) >> 12;
-			fetcher.low = ppu_read_v(pattern_table + tile | fine_y);
+			fetcher.low = read_video(bg_pattern_address());
 			break;
 		}
 		case 7:
 		{
-			const auto pattern_table = static_cast<uint16_t>(ctrl & CtrlFlags::BGPatternAddress) << 8;
-			const auto tile = static_cast<uint16_t>(fetcher.nametable_tile) << 4;
-			const uint16_t fine_y = (v & VramMask::FineY) >> 12;
-			fetcher.high = ppu_read_v((pattern_table + tile | fine_y) + 8);
+			fetcher.high = read_video(bg_pattern_address() + 8);
 			increment_x();
 			break;
 		}
 		}
 	}
 
+	void PPU::fetch_attribute()
+	{
+		const uint8_t attribute = read_video(0x23C0 | (v & 0x0C00) | ((v >> 4) & 0x38) | ((v >> 2) & 0x07));
+		const uint8_t row = ((v & VramMask::CoarseY) >> 4) & 0x4;
+		const uint8_t column = (v & VramMask::CoarseX) & 0x2;
+
+		// if row 1 is selected then shift the bottom tiles up front
+		// then select between column 1 or 2 and mask the result
+		fetcher.tile_attribute = (attribute >> (row | column)) & 0x3;
+	}
+
+	uint16_t PPU::bg_pattern_address() const
+	{
+		const auto pattern_table = static_cast<uint16_t>(ctrl & CtrlFlags::BGPatternAddress) << 8;
+		const auto tile = static_cast<uint16_t>(fetcher.nametable_tile) << 4;
+		const uint16_t fine_y = (v & VramMask::FineY) >> 12;
+		return pattern_table + tile | fine_y;
+	}
+
 	// from https://www.nesdev.org/wiki/PPU_scrolling
 	void PPU::increment_x()
 	{
@@ -398,11 +519,55 @@ namespace NESterpiece
 			v++;
 	}
 
+	void PPU::write_oam(uint8_t address, uint8_t value)
+	{
+		// keep sprites_at_y current when a y coordinate moves
+		if ((address & 3) == 0)
+		{
+			const uint64_t bit = uint64_t(1) << (address >> 2);
+			sprites_at_y[oam[address]] &= ~bit;
+			sprites_at_y[value] |= bit;
+		}
+		oam[address] = value;
+	}
+
+	void PPU::rebuild_sprite_index()
+	{
+		sprites_at_y.fill(0);
+		for (uint32_t i = 0; i < 64; ++i)
+			sprites_at_y[oam[i * 4]] |= uint64_t(1) << i;
+	}
+
 	bool PPU::rendering_enabled() const
 	{
 		return (mask & MaskFlags::ShowBG) || (mask & MaskFlags::ShowSprites);
 	}
 
+	// with rendering off the ppu shows the backdrop color
+	void PPU::output_backdrop(uint16_t x, uint16_t count)
+	{
+		if (!output_enabled)
+			return;
+
+		std::fill_n(&frame.pixels[(scanline_num * 256) + x], count, output_index(palette_memory[0]));
+	}
+
+	void Frame::convert(uint32_t *pixels, uint32_t stride) const
+	{
+		convert(pixels, stride, EmphasisPalette2C02.data());
+	}
+
+	void Frame::convert(uint32_t *pixels, uint32_t stride, const uint32_t *colors) const
+	{
+		for (uint32_t y = 0; y < SCREEN_HEIGHT; ++y)
+		{
+			const uint16_t *line = &this->pixels[y * SCREEN_WIDTH];
+			uint32_t *out = pixels + (y * stride);
+			for (uint32_t x = 0; x < SCREEN_WIDTH; ++x)
+				out[x] = colors[line[x]];
+		}
+	}
+
 	bool PPU::frame_ended()
 	{
 		bool result = _frame_ended;
@@ -474,11 +639,7 @@ namespace NESterpiece
 		}
 		case 0x4:
 		{
-			if (frame_num == 4)
-			{
-				int dummy = 0;
-			}
-			oam[oam_address] = value;
+			write_oam(oam_address, value);
 			oam_address++;
 			return;
 		}
@@ -530,13 +691,9 @@ namespace NESterpiece
 
 	std::tuple<uint8_t, bool> PPU::ppu_read(uint16_t address)
 	{
-		if (within_range<uint16_t>(address, 0x0000, 0x1FFF))
+		if (address < 0x3F00)
 		{
-			return {core.bus.cart->read_chr(address), true};
-		}
-		else if (within_range<uint16_t>(address, 0x2000, 0x3EFF))
-		{
-			return {core.bus.cart->read_nametable(address & 0x0FFF), true};
+			return {read_video(address), true};
 		}
 		else if (within_range<uint16_t>(address, 0x3F00, 0x3F1F))
 		{
@@ -562,6 +719,14 @@ namespace NESterpiece
 		return {0, false};
 	}
 
+	uint8_t PPU::read_unmapped(uint16_t address)
+	{
+		if (address < 0x2000)
+			return core.bus.cart->read_chr(address);
+
+		return core.bus.cart->read_nametable(address & 0x0FFF);
+	}
+
 	uint8_t PPU::ppu_read_v(uint16_t addr)
 	{
 		auto [v, _] = ppu_read(addr);
@@ -570,13 +735,14 @@ namespace NESterpiece
 
 	void PPU::ppu_write(uint16_t address, uint8_t value)
 	{
-		if (within_range<uint16_t>(address, 0x0000, 0x1FFF))
-		{
-			core.bus.cart->write_chr(address, value);
-		}
-		else if (within_range<uint16_t>(address, 0x2000, 0x3EFF))
+		if (address < 0x3F00)
 		{
-			core.bus.cart->write_nametable(address & 0x0FFF, value);
+			if (uint8_t *page = memory_map.write_pages[address >> PAGE_SHIFT])
+				page[address & (PAGE_SIZE - 1)] = value;
+			else if (address < 0x2000)
+				core.bus.cart->write_chr(address, value);
+			else
+				core.bus.cart->write_nametable(address & 0x0FFF, value);
 		}
 		else if (within_range<uint16_t>(address, 0x3F00, 0x3F1F))
 		{
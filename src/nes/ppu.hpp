@@ -1,12 +1,14 @@
 #pragma once
+#include "memory_map.hpp"
+#include "chr_cache.hpp"
 #include <cinttypes>
 #include <array>
-#include <vector>
 #include <tuple>
 
 namespace NESterpiece
 {
 	class Core;
+	class StateArchive;
 	enum CtrlFlags
 	{
 		NametableSelectCtrl = 3,
@@ -63,11 +65,28 @@ namespace NESterpiece
 		uint16_t low = 0, high = 0;
 	};
 
-	struct ObjectShiftRegister
+	// the sprite pixel at one x of the next line. like the hardware the lowest oam entry
+	// with an opaque pixel owns it, and its priority bit alone decides whether an opaque
+	// background covers it. a sprite behind the background still hides every later sprite
+	struct SpritePixel
 	{
-		bool is_sprite0 = false;
-		uint8_t attribute = 0, x_position = 0;
-		uint8_t pattern_low = 0, pattern_high = 0;
+		// $3F10-$3F1F palette address, 0 when no sprite covers this x
+		uint8_t palette_address = 0;
+		bool behind_bg = false, is_sprite0 = false;
+	};
+
+	// one finished picture. every pixel is its palette index with the color emphasis bits
+	// of $2001 above it, an index into a 64 * 8 entry table like EmphasisPalette2C02, so
+	// emphasis changed in the middle of a line shows from the dot it was written on
+	struct Frame
+	{
+		std::array<uint16_t, 256 * 240> pixels{};
+
+		// expands the pixels to 0xRRGGBBAA, stride is in pixels
+		void convert(uint32_t *out, uint32_t stride) const;
+		// same but looks colors up in a 64 * 8 entry table laid out like EmphasisPalette2C02,
+		// so a frontend can pre-map it to whatever pixel format its texture uses
+		void convert(uint32_t *out, uint32_t stride, const uint32_t *palette) const;
 	};
 
 	struct PPUSnapshot
@@ -104,10 +123,18 @@ namespace NESterpiece
 
 		FetcherState fetcher;
 		BGShiftRegister bg_pixels, bg_attributes;
-		std::vector<ObjectShiftRegister> oam_shifters{};
+		std::array<SpritePixel, 256> sprite_line{};
 		std::array<uint8_t, 0x20> palette_memory{};
 		std::array<uint8_t, 0x100> oam{};
-		std::array<uint32_t, 256 * 240> framebuffer{};
+		// bit n of entry y is set when oam entry n has its y coordinate at y
+		std::array<uint64_t, 0x100> sprites_at_y{};
+		// the picture being drawn, complete from the start of vblank until the next frame's
+		// first visible line. whoever shows it copies it out at vblank
+		Frame frame;
+		// cleared for frames nobody will see, e.g. run-ahead, skips drawing whole lines.
+		// dots drawn one by one are still written
+		bool output_enabled = true;
+		VideoMemoryMap memory_map;
 
 		PPUSnapshot snapshot;
 		SnapshotEvent update_event = SnapshotEvent::OnScanlineCycle;
@@ -116,17 +143,36 @@ namespace NESterpiece
 
 		PPU(Core &core);
 		void reset();
+		// everything but the frame buffers, a state loaded mid frame shows the old picture
+		// above the current line until it's drawn again
+		void serialize(StateArchive &archive);
 		void update_snapshot();
 		void step();
+		bool can_render_line() const;
+		void render_line();
+		void next_scanline();
+		void start_vblank();
+		void start_prerender();
+		void skip_odd_dot();
 		void check_snapshots();
 		void sprite_eval();
+		void output_backdrop(uint16_t x, uint16_t count);
+		void write_oam(uint8_t address, uint8_t value);
+		void rebuild_sprite_index();
 		void run_fetcher();
+		void fetch_attribute();
+		uint16_t bg_pattern_address() const;
 		void increment_x();
 		void increment_y();
 		void copy_x();
 		void copy_y();
 		void increment_vram();
 		bool rendering_enabled() const;
+
+		uint16_t output_index(uint8_t palette_value) const
+		{
+			return ((mask >> 5) << 6) | (palette_value & (mask & MaskFlags::Grayscale ? 0x30 : 0x3F));
+		}
 		bool frame_ended();
 
 		uint8_t cpu_read(uint16_t address);
@@ -134,5 +180,25 @@ namespace NESterpiece
 		std::tuple<uint8_t, bool> ppu_read(uint16_t address);
 		uint8_t ppu_read_v(uint16_t addr);
 		void ppu_write(uint16_t address, uint8_t value);
+		uint8_t read_unmapped(uint16_t address);
+
+		// pattern table and nametable reads, address must be below $3F00
+		uint8_t read_video(uint16_t address)
+		{
+			if (const uint8_t *page = memory_map.read_pages[address >> PAGE_SHIFT])
+				return page[address & (PAGE_SIZE - 1)];
+
+			return read_unmapped(address);
+		}
+
+		// both bitplanes of the pattern row at address (plane 0), from the chr cache when
+		// the page has one
+		TileRow fetch_row(uint16_t address)
+		{
+			if (const TileRow *rows = memory_map.pattern_rows[address >> PAGE_SHIFT])
+				return rows[((address & (PAGE_SIZE - 1)) >> 4 << 3) | (address & 7)];
+
+			return decode_tile_row(read_video(address), read_video(address + 8));
+		}
 	};
 }
\ No newline at end of file
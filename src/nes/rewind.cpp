@@ -0,0 +1,193 @@
+#include "rewind.hpp"
+#include <cstring>
+
+namespace NESterpiece
+{
+	static void write_length(std::vector<uint8_t> &out, size_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(static_cast<uint8_t>(value) | 0x80);
+			value >>= 7;
+		}
+		out.push_back(static_cast<uint8_t>(value));
+	}
+
+	static size_t read_length(const uint8_t *&in)
+	{
+		size_t value = 0;
+		for (uint32_t shift = 0;; shift += 7)
+		{
+			const uint8_t byte = *in++;
+			value |= static_cast<size_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+	}
+
+	RewindBuffer::RewindBuffer(size_t memory_budget, uint32_t keyframe_interval)
+		: memory_budget(memory_budget), keyframe_interval(keyframe_interval ? keyframe_interval : 1)
+	{
+	}
+
+	void RewindBuffer::set_memory_budget(size_t budget)
+	{
+		memory_budget = budget;
+		while (memory_used > memory_budget && !entries.empty())
+			drop_oldest();
+	}
+
+	void RewindBuffer::clear()
+	{
+		entries.clear();
+		memory_used = 0;
+		deltas_since_keyframe = 0;
+		keyframe.clear();
+	}
+
+	void RewindBuffer::push(const std::vector<uint8_t> &state, uint8_t buttons)
+	{
+		Entry entry{std::move(spare)};
+		entry.data.clear();
+		entry.buttons = buttons;
+
+		entry.keyframe = entries.empty() || state.size() != keyframe.size() || deltas_since_keyframe + 1 >= keyframe_interval;
+		if (entry.keyframe)
+		{
+			keyframe = state;
+			deltas_since_keyframe = 0;
+			encode(state.data(), nullptr, state.size(), entry.data);
+		}
+		else
+		{
+			++deltas_since_keyframe;
+			encode(state.data(), keyframe.data(), state.size(), entry.data);
+		}
+
+		memory_used += entry.data.capacity();
+		entries.push_back(std::move(entry));
+
+		while (memory_used > memory_budget && !entries.empty())
+			drop_oldest();
+	}
+
+	bool RewindBuffer::peek(std::vector<uint8_t> &state, uint8_t &buttons) const
+	{
+		if (entries.empty())
+			return false;
+
+		const Entry &entry = entries.back();
+		if (entry.keyframe)
+			state.assign(keyframe.size(), 0);
+		else
+			state = keyframe;
+		decode(entry.data, state.data(), state.size());
+		buttons = entry.buttons;
+		return true;
+	}
+
+	bool RewindBuffer::pop()
+	{
+		if (entries.empty())
+			return false;
+
+		Entry &entry = entries.back();
+		const bool was_keyframe = entry.keyframe;
+		release(entry);
+		entries.pop_back();
+
+		if (!was_keyframe)
+		{
+			--deltas_since_keyframe;
+			return true;
+		}
+
+		// the remaining deltas belong to the keyframe before, decode that one
+		const size_t state_size = keyframe.size();
+		keyframe.clear();
+		deltas_since_keyframe = 0;
+		for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+		{
+			if (it->keyframe)
+			{
+				keyframe.assign(state_size, 0);
+				decode(it->data, keyframe.data(), keyframe.size());
+				break;
+			}
+			++deltas_since_keyframe;
+		}
+
+		return true;
+	}
+
+	void RewindBuffer::drop_oldest()
+	{
+		// a keyframe goes together with its deltas, they're useless without it
+		do
+		{
+			release(entries.front());
+			entries.pop_front();
+		} while (!entries.empty() && !entries.front().keyframe);
+	}
+
+	void RewindBuffer::release(Entry &entry)
+	{
+		memory_used -= entry.data.capacity();
+		if (entry.data.capacity() > spare.capacity())
+			spare = std::move(entry.data);
+	}
+
+	// a sequence of (zero run length, literal length, literal bytes) over state ^ base,
+	// lengths are little endian base 128. base may be null to encode state itself
+	void RewindBuffer::encode(const uint8_t *state, const uint8_t *base, size_t size, std::vector<uint8_t> &out)
+	{
+		auto diff = [&](size_t i) -> uint8_t
+		{
+			return base ? state[i] ^ base[i] : state[i];
+		};
+
+		size_t i = 0;
+		while (i < size)
+		{
+			const size_t zeros_start = i;
+			// skip unchanged bytes eight at a time first
+			while (i + 8 <= size)
+			{
+				uint64_t a = 0, b = 0;
+				std::memcpy(&a, state + i, 8);
+				if (base)
+					std::memcpy(&b, base + i, 8);
+				if (a != b)
+					break;
+				i += 8;
+			}
+			while (i < size && diff(i) == 0)
+				++i;
+
+			// a literal only ends at two zero bytes in a row, a single one is cheaper inline
+			const size_t literal_start = i;
+			while (i < size && (diff(i) != 0 || (i + 1 < size && diff(i + 1) != 0)))
+				++i;
+
+			write_length(out, literal_start - zeros_start);
+			write_length(out, i - literal_start);
+			for (size_t j = literal_start; j < i; ++j)
+				out.push_back(diff(j));
+		}
+	}
+
+	// xors the encoded bytes into out
+	void RewindBuffer::decode(const std::vector<uint8_t> &in, uint8_t *out, size_t size)
+	{
+		const uint8_t *data = in.data();
+		const uint8_t *end = data + in.size();
+		size_t position = 0;
+		while (data < end)
+		{
+			position += read_length(data);
+			const size_t literal = read_length(data);
+			for (size_t i = 0; i < literal && position < size; ++i)
+				out[position++] ^= *data++;
+		}
+	}
+}
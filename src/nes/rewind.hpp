@@ -0,0 +1,58 @@
+#pragma once
+#include <cinttypes>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace NESterpiece
+{
+	// history of save states for rewinding, newest last, each with the buttons of the frame
+	// that was run from it. every keyframe_interval-th state
+	// is a keyframe, the ones in between are stored as their xor against that keyframe.
+	// both are run length encoded, so a mostly unchanged machine costs a few hundred bytes
+	// per frame. once the budget is exceeded the oldest keyframe and its deltas are dropped
+	class RewindBuffer
+	{
+		struct Entry
+		{
+			std::vector<uint8_t> data;
+			bool keyframe = false;
+			uint8_t buttons = 0;
+		};
+
+		std::deque<Entry> entries;
+		size_t memory_budget = 0, memory_used = 0;
+		uint32_t keyframe_interval = 0, deltas_since_keyframe = 0;
+		// the newest keyframe decoded, every delta pushed after it is against this
+		std::vector<uint8_t> keyframe;
+		// storage of the last dropped entry, reused so pushing rarely allocates
+		std::vector<uint8_t> spare;
+
+	public:
+		explicit RewindBuffer(size_t memory_budget = 64 << 20, uint32_t keyframe_interval = 60);
+
+		void set_memory_budget(size_t budget);
+		void clear();
+		void push(const std::vector<uint8_t> &state, uint8_t buttons);
+		// the newest state and its buttons, false when there's no history left
+		bool peek(std::vector<uint8_t> &state, uint8_t &buttons) const;
+		// forgets the newest state, false when there's no history left
+		bool pop();
+
+		size_t size() const
+		{
+			return entries.size();
+		}
+
+		size_t memory_usage() const
+		{
+			return memory_used;
+		}
+
+	private:
+		void drop_oldest();
+		void release(Entry &entry);
+		static void encode(const uint8_t *state, const uint8_t *base, size_t size, std::vector<uint8_t> &out);
+		static void decode(const std::vector<uint8_t> &in, uint8_t *out, size_t size);
+	};
+}
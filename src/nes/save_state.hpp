@@ -0,0 +1,63 @@
+#pragma once
+#include <cinttypes>
+#include <cstring>
+#include <type_traits>
+
+namespace NESterpiece
+{
+	// walks the machine state in a fixed order. every component has one serialize() that
+	// is run to measure, save or load, and every field is a single memcpy of its object
+	// representation in native byte order. structs with padding are passed member by
+	// member so saved states of identical machines are byte for byte identical
+	class StateArchive
+	{
+	public:
+		enum class Mode
+		{
+			Measure,
+			Save,
+			Load,
+		};
+
+	private:
+		Mode mode;
+		uint8_t *target = nullptr;
+		const uint8_t *source = nullptr;
+		size_t position = 0;
+
+	public:
+		explicit StateArchive(Mode mode) : mode(mode) {}
+		StateArchive(uint8_t *target) : mode(Mode::Save), target(target) {}
+		StateArchive(const uint8_t *source) : mode(Mode::Load), source(source) {}
+
+		template <class... T>
+		void operator()(T &...values)
+		{
+			(field(values), ...);
+		}
+
+		bool loading() const
+		{
+			return mode == Mode::Load;
+		}
+
+		size_t size() const
+		{
+			return position;
+		}
+
+	private:
+		template <class T>
+		void field(T &value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "state fields are copied as raw bytes");
+
+			if (mode == Mode::Save)
+				std::memcpy(target + position, &value, sizeof(T));
+			else if (mode == Mode::Load)
+				std::memcpy(&value, source + position, sizeof(T));
+
+			position += sizeof(T);
+		}
+	};
+}
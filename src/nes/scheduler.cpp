@@ -0,0 +1,77 @@
+#include "scheduler.hpp"
+#include "save_state.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace NESterpiece
+{
+	static bool later_event(const ScheduledEvent &a, const ScheduledEvent &b)
+	{
+		return a.timestamp > b.timestamp;
+	}
+
+	void Scheduler::clear()
+	{
+		events.clear();
+	}
+
+	void Scheduler::schedule(EventType type, uint64_t timestamp)
+	{
+		// e.g. a read-modify-write of $4014 starts oam dma twice
+		for (auto &event : events)
+		{
+			if (event.type != type)
+				continue;
+
+			if (timestamp < event.timestamp)
+			{
+				event.timestamp = timestamp;
+				std::make_heap(events.begin(), events.end(), later_event);
+			}
+			return;
+		}
+
+		events.push_back({
+			.timestamp = timestamp,
+			.type = type,
+		});
+		std::push_heap(events.begin(), events.end(), later_event);
+	}
+
+	ScheduledEvent Scheduler::pop()
+	{
+		std::pop_heap(events.begin(), events.end(), later_event);
+		const ScheduledEvent event = events.back();
+		events.pop_back();
+		return event;
+	}
+
+	void Scheduler::cancel(EventType type)
+	{
+		const auto removed = std::remove_if(events.begin(), events.end(), [type](const ScheduledEvent &event)
+											{ return event.type == type; });
+		if (removed == events.end())
+			return;
+
+		events.erase(removed, events.end());
+		std::make_heap(events.begin(), events.end(), later_event);
+	}
+
+	void Scheduler::serialize(StateArchive &archive)
+	{
+		// fixed number of slots in heap order, so the layout doesn't depend on what's pending
+		assert(events.size() <= SAVED_EVENTS);
+		uint32_t count = static_cast<uint32_t>(events.size());
+		archive(count);
+		if (archive.loading())
+			events.resize(std::min(count, SAVED_EVENTS));
+
+		for (uint32_t i = 0; i < SAVED_EVENTS; ++i)
+		{
+			ScheduledEvent event = i < events.size() ? events[i] : ScheduledEvent{};
+			archive(event.timestamp, event.type);
+			if (archive.loading() && i < events.size())
+				events[i] = event;
+		}
+	}
+}
\ No newline at end of file
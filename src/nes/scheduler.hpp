@@ -0,0 +1,47 @@
+#pragma once
+#include <cinttypes>
+#include <vector>
+#include <limits>
+
+namespace NESterpiece
+{
+	class StateArchive;
+
+	enum class EventType
+	{
+		VBlank,
+		PreRender,
+		OddFrameSkip,
+		OAMDMA,
+		// ends Core::run_until at a cycle budget or ppu position
+		StopRun,
+	};
+
+	struct ScheduledEvent
+	{
+		uint64_t timestamp = 0;
+		EventType type = EventType::VBlank;
+	};
+
+	// min-heap of pending events ordered by their master clock timestamp
+	class Scheduler
+	{
+		std::vector<ScheduledEvent> events{};
+
+	public:
+		// at most one event of each type is pending, states keep room for this many
+		static constexpr uint32_t SAVED_EVENTS = 8;
+
+		void clear();
+		// an event of a type that's already pending keeps the earlier of the two timestamps
+		void schedule(EventType type, uint64_t timestamp);
+		ScheduledEvent pop();
+		void cancel(EventType type);
+		void serialize(StateArchive &archive);
+
+		uint64_t next_timestamp() const
+		{
+			return events.empty() ? std::numeric_limits<uint64_t>::max() : events.front().timestamp;
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <cinttypes>
+#include <array>
+#include <atomic>
+#include <optional>
+
+namespace NESterpiece
+{
+	// bounded single producer, single consumer queue. unlike BusTrace every element is
+	// handed over exactly once, push() reports a full queue and leaves it to the caller
+	template <class T, uint32_t Capacity>
+	class SPSCQueue
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+		std::array<T, Capacity> entries{};
+		alignas(64) std::atomic<uint64_t> write_index = 0;
+		alignas(64) std::atomic<uint64_t> read_index = 0;
+
+	public:
+		bool push(T value)
+		{
+			const uint64_t head = write_index.load(std::memory_order_relaxed);
+			if (head - read_index.load(std::memory_order_acquire) == Capacity)
+				return false;
+
+			entries[head % Capacity] = std::move(value);
+			write_index.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		std::optional<T> pop()
+		{
+			const uint64_t tail = read_index.load(std::memory_order_relaxed);
+			if (tail == write_index.load(std::memory_order_acquire))
+				return std::nullopt;
+
+			std::optional<T> value = std::move(entries[tail % Capacity]);
+			read_index.store(tail + 1, std::memory_order_release);
+			return value;
+		}
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "core.hpp"
+#include <cinttypes>
+
+namespace NESterpiece
+{
+	// 64-bit fnv-1a
+	class StateHash
+	{
+		uint64_t value = 0xCBF29CE484222325;
+
+	public:
+		void add(const uint8_t *data, size_t size)
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				value ^= data[i];
+				value *= 0x100000001B3;
+			}
+		}
+
+		template <class T>
+		void add(const T &data)
+		{
+			add(reinterpret_cast<const uint8_t *>(&data), sizeof(T));
+		}
+
+		uint64_t result() const
+		{
+			return value;
+		}
+	};
+
+	// fingerprint of everything a game can observe plus the picture, which is finished when
+	// taken at vblank. equal hashes after the same inputs mean two runs behaved the same
+	inline uint64_t hash_state(const Core &core)
+	{
+		StateHash hash;
+		const auto &regs = core.cpu.registers;
+		hash.add(regs.a);
+		hash.add(regs.x);
+		hash.add(regs.y);
+		hash.add(regs.s);
+		hash.add(regs.p);
+		hash.add(regs.pc);
+		hash.add(core.bus.internal_ram);
+
+		const auto &ppu = core.ppu;
+		hash.add(ppu.ctrl);
+		hash.add(ppu.mask);
+		hash.add(ppu.status);
+		hash.add(ppu.v);
+		hash.add(ppu.t);
+		hash.add(ppu.fine_x_scroll);
+		hash.add(ppu.palette_memory);
+		hash.add(ppu.oam);
+
+		// pattern tables and nametables, whatever the cartridge has mapped
+		for (const uint8_t *page : ppu.memory_map.read_pages)
+		{
+			if (page)
+				hash.add(page, PAGE_SIZE);
+		}
+
+		hash.add(ppu.frame.pixels);
+		return hash.result();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cinttypes>
+#include <array>
+#include <atomic>
+
+namespace NESterpiece
+{
+	// three copies of T shared by one producer and one consumer thread. the producer fills
+	// back() and publish()es it, the consumer calls acquire() to swap in the newest
+	// published copy and reads front(). neither side ever waits for the other
+	template <class T>
+	class TripleBuffer
+	{
+		static constexpr uint8_t FRESH = 4;
+
+		std::array<T, 3> buffers{};
+		uint8_t back_index = 0, front_index = 1;
+		// index of the buffer in between, FRESH when it's newer than front
+		std::atomic<uint8_t> middle = 2;
+
+	public:
+		T &back()
+		{
+			return buffers[back_index];
+		}
+
+		const T &front() const
+		{
+			return buffers[front_index];
+		}
+
+		void publish()
+		{
+			back_index = middle.exchange(back_index | FRESH, std::memory_order_acq_rel) & 3;
+		}
+
+		// returns false when nothing was published since the last call
+		bool acquire()
+		{
+			if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+				return false;
+
+			front_index = middle.exchange(front_index, std::memory_order_acq_rel) & 3;
+			return true;
+		}
+	};
+}